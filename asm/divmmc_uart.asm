@@ -7,6 +7,15 @@ SECTION code_user
 
 EXTERN _frame_wait
 EXTERN _rb_push
+IFDEF ST_IM2
+EXTERN im2_rx_busy
+ENDIF
+IFDEF ST_PASSIVE
+EXTERN _esp_passive
+EXTERN _esp_tx_wrap
+EXTERN _esp_tx_byte
+PUBLIC _uart_read_byte
+ENDIF
 PUBLIC _ay_uart_init
 PUBLIC _ay_uart_send
 PUBLIC uartRead
@@ -48,6 +57,21 @@ uartRead:
     in a, (c)
     ret
 
+IFDEF ST_PASSIVE
+; -----------------------------------------------------------------------------
+; int16_t uart_read_byte(void)
+; Passive link: AT replies are read straight from the UART, never via the ring.
+; Return: HL = byte, or -1 if none is waiting.
+; -----------------------------------------------------------------------------
+_uart_read_byte:
+    call uartRead
+    ld h, 0
+    ld l, a
+    ret c
+    ld hl, -1
+    ret
+ENDIF
+
 ; -----------------------------------------------------------------------------
 ; _ay_uart_init
 ; OPTIMIZACIÓN: Reducción de tiempos de espera y bucle de flush ajustado
@@ -95,6 +119,23 @@ uartInit_flush:
 ; -----------------------------------------------------------------------------
 _ay_uart_send:
     ; L = byte to send (fastcall), preserved until out (c), l at end
+IFDEF ST_PASSIVE
+    ld a, (_esp_tx_wrap)
+    or a
+    jr z, uartSend_raw
+    push de                 ; ASM callers keep DE/BC across a send
+    push bc
+    call _esp_tx_byte       ; queued for one CIPSEND; sent through here unwrapped
+    pop bc
+    pop de
+    ret
+uartSend_raw:
+ENDIF
+IFDEF ST_IM2
+    ld a, (im2_rx_busy)
+    inc a
+    ld (im2_rx_busy), a     ; IM2 drain must not reselect the UART register
+ENDIF
 
     ; Select status register for TX-ready polling.
     ld bc, ZXUNO_ADDR
@@ -111,6 +152,11 @@ uartSend_wait_tx:
     add a, a                ; TX-busy bit -> Sign, RX-ready bit -> Carry
     jp p, uartSend_tx_ready
     jr nc, uartSend_wait_tx
+IFDEF ST_PASSIVE
+    ld a, (_esp_passive)
+    or a
+    jr nz, uartSend_hold    ; AT replies are not IRC data: leave them queued
+ENDIF
 
     push hl                 ; preserve byte to send in L
     dec b                   ; select UART DATA register through $FC3B
@@ -128,6 +174,28 @@ uartSend_wait_tx:
     inc b
     jr uartSend_wait_tx
 
+IFDEF ST_PASSIVE
+    ; Passive link, TX busy with an AT reply waiting: poll TX alone and give
+    ; the frame interrupt a HALT every 256 polls, so a stalled ESP costs
+    ; frames, not a DI spin. frame_wait keeps BC and the register select.
+uartSend_hold:
+    push de
+    push hl
+uartSend_hold_frame:
+    ld d, 0
+uartSend_hold_poll:
+    in a, (c)
+    add a, a                ; TX-busy bit -> Sign
+    jp p, uartSend_hold_done
+    dec d
+    jr nz, uartSend_hold_poll
+    call _frame_wait
+    jr uartSend_hold_frame
+uartSend_hold_done:
+    pop hl
+    pop de
+ENDIF
+
 uartSend_tx_ready:
     ; OPT: dec b switches BC from ZXUNO_REG (FD3B) to ZXUNO_ADDR (FC3B)
     dec b
@@ -136,4 +204,9 @@ uartSend_tx_ready:
 
     inc b
     out (c), l          ; OPT: direct from fastcall reg, no push/pop
+IFDEF ST_IM2
+    ld a, (im2_rx_busy)
+    dec a
+    ld (im2_rx_busy), a
+ENDIF
     ret
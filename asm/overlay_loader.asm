@@ -23,6 +23,22 @@ EXTERN _rx_overflow
 EXTERN _overlay_exit_full
 EXTERN _input_cache_invalidate
 EXTERN ___sdcc_enter_ix
+IFDEF ST_RECORD
+EXTERN _rec_flush
+ENDIF
+IFDEF ST_PASSIVE
+EXTERN _esp_passive
+ENDIF
+IFDEF ST_BANK128
+EXTERN _bank_pump
+ENDIF
+IFDEF ST_IM2
+EXTERN _im2_window_close
+ENDIF
+IFDEF ST_TRACE
+EXTERN trace_rec
+defc TR_OVERLAY = 4         ; spectalk.h
+ENDIF
 
 OVL_ATLAS_HEADER_LEN EQU 64
 
@@ -31,9 +47,32 @@ OVL_ATLAS_HEADER_LEN EQU 64
 PUBLIC _overlay_exec
 _overlay_exec:
     call ___sdcc_enter_ix
+IFDEF ST_IM2
+    call _im2_window_close  ; ring_buffer is about to hold overlay code
+ENDIF
 
     ; Drain UART before overlay (ring_buffer will be overwritten)
+IFDEF ST_PASSIVE
+    ld a, (_esp_passive)
+    or a
+    jr nz, ovl_exec_drained ; passive link: pending data waits on the ESP
+ENDIF
     call _uart_drain_to_buffer
+IFDEF ST_PASSIVE
+ovl_exec_drained:
+ENDIF
+IFDEF ST_RECORD
+    call _rec_flush         ; !record: put unwritten ring bytes on SD first
+ENDIF
+IFDEF ST_BANK128
+    call _bank_pump         ; 128K: pending bytes survive the load in the bank
+ENDIF
+IFDEF ST_TRACE
+    ld l, (ix+4)
+    ld h, (ix+5)            ; arg = entry_id << 8 | ovl_id
+    ld a, TR_OVERLAY
+    call trace_rec
+ENDIF
 
     ; Open SPECTALK.OVL
     ld hl, ovl_filename
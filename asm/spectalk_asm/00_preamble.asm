@@ -48,6 +48,10 @@ bss_loop:
     or c
     jr nz, bss_loop
 bss_zero_skip:
+IFDEF ST_BANK128
+    ld a, (0x5B5C)          ; BANKM: last value the 128K ROM wrote to $7FFD
+    ld (bank_bankm), a
+ENDIF
     ; OPT-SHRINK: zero_fill_256 subroutine saves 5B for 2 identical fills
     ; Zero Printer Buffer: 0x5B00..0x5BFF (256 bytes)
     ld hl, 0x5B00
@@ -101,6 +105,11 @@ SCREEN_HEIGHT   EQU 24          ; Physical screen height in rows
 RING_SIZE       EQU 2048        ; == RING_BUFFER_SIZE  (spectalk.h:85)
 RING_MASK       EQU 0x07FF      ; == RING_BUFFER_MASK  (spectalk.h:86)
 RX_LINE_MAX     EQU 510         ; == RX_LINE_SIZE - 2  (spectalk.h:103)
+LFQ_MASK        EQU 63          ; == LFQ_SIZE - 1 (spectalk.h)
+; RxStats rx_stats field offsets (spectalk.h), 16-bit wrapping counters
+RXS_PEAK        EQU 0           ; highest ring occupancy at drain commit
+RXS_FULL        EQU 2           ; pushes/drains stopped by a full ring
+RXS_LOST        EQU 4           ; lines discarded through _rx_overflow
 
 ; =============================================================================
 ; PUBLIC FUNCTIONS (visible from C)
@@ -113,7 +122,7 @@ PUBLIC _channel_name_ptr
 PUBLIC _channel_flags_ptr
 PUBLIC _l_channel_flags_ptr
 PUBLIC _channel_dec_users
-PUBLIC _friend_initial_match
+PUBLIC _friend_hash_hit
 PUBLIC _is_tracked_friend
 PUBLIC _irc_param_0
 PUBLIC _irc_param_1
@@ -141,13 +150,18 @@ PUBLIC _clear_line
 PUBLIC _clear_zone
 PUBLIC _compute_screen_base
 PUBLIC _st_stricmp
+PUBLIC _irc_hash
 PUBLIC _st_stristr
+PUBLIC _hl_match
 PUBLIC _u16_to_dec
 PUBLIC _str_to_u16
 PUBLIC _uart_send_string
 PUBLIC _rb_pop
 PUBLIC _rb_push
 PUBLIC _try_read_line_nodrain
+PUBLIC _try_read_line_zc
+PUBLIC _rx_line_release
+PUBLIC _rx_ring_discard
 PUBLIC _reapply_screen_attributes
 PUBLIC _cls_fast
 PUBLIC _uart_drain_to_buffer
@@ -253,11 +267,45 @@ defc _overlay_slot = _rx_line   ; alias ? mutually exclusive with IRC receive
 EXTERN _rx_pos
 EXTERN _rx_overflow
 EXTERN _rx_last_len
+EXTERN _rx_stats
+EXTERN _rx_burst_lost
+EXTERN _scroll_count
+EXTERN _irc_hash_end
+EXTERN _irc_nick
+EXTERN _highlight_words
+EXTERN _hl_tab
+EXTERN _hl_min
+EXTERN _rx_ptr
+EXTERN _rx_zc_held
+EXTERN _rx_zc_start
+EXTERN _rx_zc_next
+EXTERN _lfq_buf
+EXTERN _lfq_rd
+EXTERN _lfq_wr
+EXTERN _lfq_over
+EXTERN _lfq_mark
+IFDEF ST_BANK128
+EXTERN _bank_ok
+EXTERN _bank_head
+EXTERN _bank_tail
+ENDIF
+IFDEF ST_RECORD
+EXTERN _rec_handle
+EXTERN _rec_tail
+EXTERN _rec_lost
+EXTERN _rec_marks
+ENDIF
+IFDEF ST_PASSIVE
+EXTERN _esp_passive
+EXTERN _esp_pull
+PUBLIC _uart_drain_raw
+ENDIF
 
 ; Ignore list (para is_ignored)
 ; Fixed high RAM: ring_buffer ends at $FCFF, stack reserve starts at $FD58.
 PUBLIC _ignore_list
 defc _ignore_list = 0xFD00  ; 80B (MAX_IGNORES * 16), $FD00-$FD4F
+EXTERN _ignore_hash
 EXTERN _ignore_count
 ; _big_status removed (big mode eliminated)
 
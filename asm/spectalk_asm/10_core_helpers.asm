@@ -175,15 +175,30 @@ _rx_pos_reset:
     ret
 
 ; -----------------------------------------------------------------------------
-; reset_rx_state: rb_head = rb_tail = rx_pos = rx_overflow = 0
+; reset_rx_state: rb_head = rb_tail = rx_pos = rx_overflow = 0 (and the bank
+; ring and the LF index)
 ; 3 call sites in C -> saves ~3 bytes per site vs inline stores
 ; -----------------------------------------------------------------------------
 _reset_rx_state:
     xor a
     ld (_rx_overflow), a
+    ld (_rx_zc_held), a         ; a held zero-copy line goes with the ring
     call _rx_pos_reset        ; HL = 0 after return
     ld (_rb_head), hl
     ld (_rb_tail), hl
+    ld (_lfq_mark), hl
+    ld (_rx_burst_lost), hl     ; a pending loss marker is stale now
+    ld (_lfq_over), a
+IFDEF ST_BANK128
+    ld (_bank_head), hl
+    ld (_bank_tail), hl
+ENDIF
+IFDEF ST_RECORD
+    ld (_rec_tail), hl          ; unwritten !record bytes go with the ring
+    ld (_rec_marks), a
+ENDIF
+    ld a, (_lfq_wr)
+    ld (_lfq_rd), a
     ret
 
 ; -----------------------------------------------------------------------------
@@ -422,3 +437,160 @@ shift_not_held:
     ret
 
 
+IFDEF ST_STACKPROBE
+; =============================================================================
+; STACK HIGH-WATER MARK (make stackprobe)
+; The CRT stack is the 512 bytes below REGISTER_SP ($FD58-$FF57). main()
+; paints it with STACK_PAINT; stack_probe() finds the lowest byte that lost
+; the paint. StackStats (spectalk.h): peak depth in bytes, then the tag.
+; =============================================================================
+defc STACK_TOP    = 0xFF58
+defc STACK_LOW    = 0xFD58
+defc STACK_BYTES  = 512
+defc STACK_PAINT  = 0xA5
+defc STACK_WINDOW = 64        ; bytes below the old peak checked per probe
+EXTERN _stack_stats
+PUBLIC _stack_paint
+PUBLIC _stack_probe
+
+; -----------------------------------------------------------------------------
+; void stack_paint(void)
+; Paint STACK_LOW up to 8 bytes below the caller's SP. Also used by
+; "!status reset" from SPCTLK4: the live frames above stay unpainted.
+; -----------------------------------------------------------------------------
+_stack_paint:
+    ld hl, -8
+    add hl, sp
+    ld de, STACK_LOW
+    or a
+    sbc hl, de                ; HL = bytes to paint
+    ret c
+    ret z
+    ld b, h
+    ld c, l
+    ld h, d
+    ld l, e
+    ld (hl), STACK_PAINT
+    dec bc
+    ld a, b
+    or c
+    ret z
+    inc de
+    ldir
+    ret
+
+; -----------------------------------------------------------------------------
+; void stack_probe(uint16_t tag) __z88dk_fastcall
+; Cheap path: if the STACK_WINDOW bytes just below the recorded peak still
+; hold the paint, nothing went deeper. Otherwise rescan from STACK_LOW and
+; record the new depth with tag (last_cmd_id, typed command or 0).
+; -----------------------------------------------------------------------------
+_stack_probe:
+    push hl                   ; tag
+    ld de, (_stack_stats)
+    ld hl, STACK_TOP - STACK_WINDOW
+    or a
+    sbc hl, de                ; HL = window start
+    ld de, STACK_LOW
+    or a
+    sbc hl, de
+    jr c, stack_probe_full    ; window reaches the floor: full scan
+    add hl, de
+    ld bc, STACK_WINDOW
+    ld a, STACK_PAINT
+stack_probe_win:
+    cpi
+    jr nz, stack_probe_full   ; a byte below the old peak was written
+    jp pe, stack_probe_win
+    pop hl
+    ret
+
+stack_probe_full:
+    ld hl, STACK_LOW
+    ld bc, STACK_BYTES
+    ld a, STACK_PAINT
+stack_probe_scan:
+    cpi
+    jr nz, stack_probe_hit
+    jp pe, stack_probe_scan
+    pop hl
+    ret
+
+stack_probe_hit:
+    dec hl                    ; deepest written byte
+    ex de, hl
+    ld hl, STACK_TOP
+    or a
+    sbc hl, de                ; HL = depth
+    ld de, (_stack_stats)
+    ex de, hl
+    or a
+    sbc hl, de                ; old peak - depth
+    pop hl
+    ret nc                    ; not deeper (full scan after a floor window)
+    ld (_stack_stats), de
+    ld (_stack_stats + 2), hl
+    ret
+ENDIF
+
+IFDEF ST_TRACE
+; =============================================================================
+; EVENT TRACE RING (make trace)
+; TraceRing (spectalk.h): head byte, then TRACE_RECORDS 4-byte records
+; {id, FRAMES low, arg lo, arg hi}. head counts records mod 256; the next
+; slot is head & TRACE_MASK. !trace (user_cmds.c) writes it to SD as-is.
+; =============================================================================
+defc TRACE_MASK = 63          ; TRACE_RECORDS - 1
+defc TR_SCROLL  = 5           ; event ids: spectalk.h
+EXTERN _trace_ring
+PUBLIC _trace_ev
+PUBLIC trace_rec
+
+; -----------------------------------------------------------------------------
+; void trace_ev(uint16_t arg, uint8_t id) __z88dk_callee
+; -----------------------------------------------------------------------------
+_trace_ev:
+    pop bc                    ; return address
+    pop hl                    ; arg
+    dec sp
+    pop af                    ; A = id
+    push bc
+
+; -----------------------------------------------------------------------------
+; trace_rec: A = event id, HL = arg. Preserves everything but F, so the
+; ASM hooks (overlay_exec, scroll_main_zone) can call it on entry.
+; -----------------------------------------------------------------------------
+trace_rec:
+    push hl
+    push de
+    push bc
+    ld b, h
+    ld c, l                   ; BC = arg
+    ld d, a                   ; D = id
+    ld hl, _trace_ring
+    ld a, (hl)
+    inc (hl)
+    and TRACE_MASK
+    ld l, a
+    ld h, 0
+    add hl, hl
+    add hl, hl
+    inc hl                    ; skip head
+    push de
+    ld de, _trace_ring
+    add hl, de
+    pop de
+    ld (hl), d                ; id
+    inc hl
+    ld a, (23672)             ; FRAMES low byte
+    ld (hl), a
+    inc hl
+    ld (hl), c
+    inc hl
+    ld (hl), b
+    ld a, d
+    pop bc
+    pop de
+    pop hl
+    ret
+ENDIF
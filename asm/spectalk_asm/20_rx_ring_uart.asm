@@ -76,6 +76,10 @@ _rb_push:
     
     ; 2. Comprobar colisi?n: ?El Futuro Head choca con el Tail actual?
     ld bc, (_rb_tail)
+IFDEF ST_RECORD
+    call rec_floor_bc       ; BC = rec_tail while !record has unwritten bytes
+rb_push_check:
+ENDIF
     or a                    ; clear carry for SBC
     sbc hl, bc              ; Z=1 if future head == tail
     add hl, bc              ; restore future head; ADD HL does not alter Z
@@ -92,20 +96,334 @@ _rb_push_ok:
     add hl, de              ; HL = direcci?n de escritura (buffer + head_viejo)
     
     ld (hl), a              ; Escribimos en memoria
-    
+    cp 0x0A
+    jr nz, rb_push_ret
+    ld b, d
+    ld c, e
+    call lfq_add            ; index the LF at the old head
+rb_push_ret:
     ld l, 1                 ; Retornar 1 (?xito)
     ret
 
 _rb_push_full:
+IFDEF ST_RECORD
+    call rec_give_up        ; CF=1: recorder released parsed bytes, retry
+    ld bc, (_rb_tail)
+    jr c, rb_push_check
+ENDIF
+    ld hl, (_rx_stats + RXS_FULL)
+    inc hl
+    ld (_rx_stats + RXS_FULL), hl
     ld l, 0             ; Retornar 0 (Fallo/Lleno)
     ret
 
+; A line was discarded: count it in rx_stats.lost and in the burst that
+; process_irc_data() reports as one "[n lines lost]". Clobbers HL.
+rx_lost_line:
+    ld hl, (_rx_stats + RXS_LOST)
+    inc hl
+    ld (_rx_stats + RXS_LOST), hl
+    ld hl, (_rx_burst_lost)
+    inc hl
+    ld (_rx_burst_lost), hl
+    ret
+
+; =============================================================================
+; LF INDEX
+; The drain and _rb_push queue the ring offset of every LF they store in
+; _lfq_buf (LFQ_SIZE entries, _lfq_rd/_lfq_wr). While the index is trusted
+; it holds exactly the LFs between _rb_tail and _rb_head, in order, so the
+; line readers find the next line end in O(1) instead of scanning for it.
+; The index stops being trusted (_lfq_over = 1) when the queue is full or
+; when something other than the line readers moved _rb_tail (flush, overlay
+; load, rb_pop, bank pump): _lfq_mark is the tail the readers last stored.
+; Untrusted, the readers scan bytes as before and only pop entries they
+; pass; it is trusted again once the scan path has emptied the ring.
+; =============================================================================
+
+; Queue the LF at ring offset BC, or mark the index untrusted when full.
+; Preserves BC, DE. Clobbers AF, HL.
+lfq_add:
+    push de
+    ld a, (_lfq_wr)
+    ld e, a                 ; E = free slot
+    inc a
+    and LFQ_MASK
+    ld d, a                 ; D = next _lfq_wr
+    ld a, (_lfq_rd)
+    cp d
+    jr z, lfq_add_full
+    ld a, d
+    ld d, 0
+    ld hl, _lfq_buf
+    add hl, de
+    add hl, de
+    ld (hl), c
+    inc hl
+    ld (hl), b
+    ld (_lfq_wr), a         ; publish after the entry is written
+    pop de
+    ret
+lfq_add_full:
+    ld a, 1
+    ld (_lfq_over), a
+    pop de
+    ret
+
+; HL = _lfq_buf[_lfq_rd]. Clobbers AF, DE.
+lfq_front:
+    ld a, (_lfq_rd)
+    ld l, a
+    ld h, 0
+    add hl, hl
+    ld de, _lfq_buf
+    add hl, de
+    ld a, (hl)
+    inc hl
+    ld h, (hl)
+    ld l, a
+    ret
+
+; Next indexed line. CF=1: index untrusted. CF=0, Z=1: no whole line in the
+; ring. CF=0, Z=0: HL = LF offset, DE = _rb_tail, BC = bytes before the LF.
+lfq_line:
+    ld hl, (_rb_tail)
+    ld de, (_lfq_mark)
+    or a
+    sbc hl, de
+    jr nz, lfq_line_off     ; tail moved behind the readers' back
+    ld a, (_lfq_over)
+    or a
+    jr nz, lfq_line_off
+    ld a, (_lfq_rd)
+    ld hl, _lfq_wr
+    cp (hl)
+    ret z                   ; no LF queued
+    call lfq_front
+    ld de, (_rb_tail)
+    push hl
+    or a
+    sbc hl, de
+    ld a, h
+    and RB_MASK_H
+    ld b, a
+    ld c, l                 ; BC = (LF - tail) & mask
+    ld hl, (_rb_head)
+    sbc hl, de              ; CF=0 from AND
+    ld a, h
+    and RB_MASK_H
+    ld h, a                 ; HL = bytes in the ring
+    sbc hl, bc              ; CF=0 from AND
+    pop hl
+    ret z                   ; LF not in the ring yet
+    ret nc
+    xor a                   ; stale entry: report no line
+    ret
+lfq_line_off:
+    ld a, 1
+    ld (_lfq_over), a
+    scf
+    ret
+
+; The reader moved past an LF; HL = ring offset just after it. Pop the
+; queue front if it is that LF. Preserves BC, DE, HL.
+lfq_pass:
+    push de
+    push hl
+    ld a, (_lfq_rd)
+    ld hl, _lfq_wr
+    cp (hl)
+    jr z, lfq_pass_ret
+    call lfq_front
+    inc hl
+    res 3, h                ; front LF + 1, as a ring offset
+    pop de
+    push de
+    or a
+    sbc hl, de
+    jr nz, lfq_pass_ret
+    ld hl, _lfq_rd
+    ld a, (hl)
+    inc a
+    and LFQ_MASK
+    ld (hl), a
+lfq_pass_ret:
+    pop hl
+    pop de
+    ret
+
+; The scan path emptied the ring up to its head snapshot (DE = _rb_tail) with
+; the index untrusted. If no byte arrived since, no LF is left in the ring:
+; drop the queue and trust it again. Preserves BC, DE.
+lfq_settle:
+IFDEF ST_IM2
+    ld hl, im2_rx_busy
+    inc (hl)                ; no IM2 drain between the compare and the reset
+ENDIF
+    ld hl, (_rb_head)
+    or a
+    sbc hl, de
+    jr nz, lfq_settle_ret
+    ld a, (_lfq_wr)
+    ld (_lfq_rd), a
+    xor a
+    ld (_lfq_over), a
+lfq_settle_ret:
+IFDEF ST_IM2
+    ld hl, im2_rx_busy
+    dec (hl)
+ENDIF
+    ret
+
+IFDEF ST_RECORD
+; -----------------------------------------------------------------------------
+; !record ring floor (make record builds only)
+; While rec_handle != 0 the bytes from _rec_tail to _rb_head are not on SD yet,
+; so pushes treat _rec_tail as the ring tail. It never runs ahead of _rb_tail.
+; -----------------------------------------------------------------------------
+; BC = _rec_tail if recording, else unchanged. Preserves AF, DE, HL.
+rec_floor_bc:
+    push af
+    ld a, (_rec_handle)
+    or a
+    jr z, rec_floor_ret
+    ld bc, (_rec_tail)
+rec_floor_ret:
+    pop af
+    ret
+
+; The ring is full against the recorder floor. Rather than stall the UART,
+; give up the bytes the parser already consumed: _rec_lost += _rb_tail -
+; _rec_tail, _rec_tail = _rb_tail. rec_flush() skips marks left behind.
+; Out: CF=1 if the floor moved (caller retries against _rb_tail), CF=0 if
+; the parser tail itself is full. Preserves A, BC, DE, HL.
+rec_give_up:
+    push af
+    push de
+    push hl
+    ld a, (_rec_handle)
+    or a
+    jr z, rec_give_up_none
+    ld hl, (_rb_tail)
+    ld de, (_rec_tail)
+    sbc hl, de              ; CF=0 from OR A
+    jr z, rec_give_up_none
+    ld a, h
+    and RING_MASK >> 8
+    ld h, a                 ; HL = bytes parsed but not written
+    ld de, (_rec_lost)
+    add hl, de
+    ld (_rec_lost), hl
+    ld hl, (_rb_tail)
+    ld (_rec_tail), hl
+    pop hl
+    pop de
+    pop af
+    scf
+    ret
+rec_give_up_none:
+    pop hl
+    pop de
+    pop af
+    or a
+    ret
+ENDIF
+
 ; -----------------------------------------------------------------------------
 ; _try_read_line_nodrain
 ; Consume el buffer buscando un \n. Si hay desbordamiento, descarta bytes
 ; de forma segura sin escribir en memoria hasta encontrar el \n.
+; With a trusted LF index and an empty rx_line, a whole line is copied with
+; LDIR (two runs when it wraps) and only the CR before its LF is dropped.
 ; -----------------------------------------------------------------------------
 _try_read_line_nodrain:
+    call rx_zc_commit       ; never re-read a line try_read_line_zc handed out
+IFDEF ST_BANK128
+    ld a, (_bank_ok)
+    or a
+    jp nz, trln_bank        ; 128K: lines come from the bank ring
+ENDIF
+trli_next:
+    ld hl, (_rx_pos)
+    ld a, (_rx_overflow)
+    or h
+    or l
+    jr nz, trln_scan        ; rx_line already holds the start of this line
+    call lfq_line
+    jr c, trln_scan         ; index untrusted: scan bytes
+    jr z, trln_scan         ; no whole line: the scan keeps the partial
+    push hl                 ; LF offset
+    ld hl, RX_LINE_MAX + 1
+    or a
+    sbc hl, bc
+    jr c, trli_lost         ; longer than rx_line: drop it like the scan path
+    ld a, b
+    or c
+    jr z, trli_skip         ; bare LF
+    ld hl, RING_SIZE
+    sbc hl, de              ; CF=0 from SBC above; HL = bytes before the wrap
+    sbc hl, bc
+    jr nc, trli_run
+    add hl, bc
+    ld b, h
+    ld c, l                 ; BC = bytes before the wrap
+trli_run:
+    ld hl, _ring_buffer
+    add hl, de
+    ld de, _rx_line
+    ldir
+    pop bc                  ; BC = LF offset = bytes after a wrap
+    ld a, h
+    cp (_ring_buffer + RING_SIZE) >> 8
+    jr nz, trli_end         ; stopped before the ring end
+    ld a, b
+    or c
+    jr z, trli_end
+    ld hl, _ring_buffer
+    ldir
+trli_end:
+    ex de, hl               ; HL = end of the copy
+    dec hl
+    ld a, (hl)
+    cp 0x0D
+    jr z, trli_cr
+    inc hl
+trli_cr:
+    ld (hl), 0
+    ld de, _rx_line
+    or a
+    sbc hl, de              ; HL = line length
+    jr z, trli_consume      ; CR only
+    ld de, RX_LINE_MAX + 1
+    sbc hl, de              ; CF=0 from SBC above
+    jr nc, trli_lost_popped ; 511 bytes and no CR
+    add hl, de
+    ld (_rx_last_len), hl
+    call trli_pass
+    ld l, 1
+    ret
+
+trli_lost:
+    pop hl
+trli_lost_popped:
+    call rx_lost_line
+    jr trli_consume
+trli_skip:
+    pop hl
+trli_consume:
+    call trli_pass
+    jr trli_next
+
+; _rb_tail = queue front LF + 1, and pop it.
+trli_pass:
+    call lfq_front
+    inc hl
+    res 3, h
+    ld (_rb_tail), hl
+    ld (_lfq_mark), hl
+    jp lfq_pass
+
+trln_scan:
     ; Cache tail, available byte count, and rx_line write pointer for this
     ; parser pass. UART drain cannot append while this routine is running.
     ld de, (_rb_tail)       ; DE = ring tail offset
@@ -176,6 +494,9 @@ trln_overflow_state:
     jr trln_loop
 
 trln_newline:
+    ex de, hl
+    call lfq_pass           ; DE = offset after this LF
+    ex de, hl
     ; Terminar string con NULL
     xor a
     ld (bc), a
@@ -188,6 +509,7 @@ trln_newline:
     
     ; If overflow, DISCARD line completa y resetear
     ld (hl), 0
+    call rx_lost_line
     ld bc, _rx_line
     jr trln_loop        ; Look for next line
 
@@ -210,11 +532,16 @@ trln_check_valid:
     ld hl, 0
     ld (_rx_pos), hl
     ld (_rb_tail), de
+    ld (_lfq_mark), de
     ld l, 1
     ret
 
 trln_return_0:
     ld (_rb_tail), de
+    ld (_lfq_mark), de
+    ld a, (_lfq_over)
+    or a
+    call nz, lfq_settle
     ld h, b
     ld l, c
     ld de, _rx_line
@@ -224,4 +551,609 @@ trln_return_0:
     ld l, 0
     ret
 
+; -----------------------------------------------------------------------------
+; uint8_t try_read_line_zc(void)
+; process_irc_data() variant of _try_read_line_nodrain. When a whole line
+; (at most RX_LINE_MAX bytes) sits between _rb_tail and the ring's wrap, it
+; is parsed in place: rx_ptr points into ring_buffer and its CR or LF becomes
+; the NUL. _rb_tail stays on the line start until rx_zc_commit, so the drain
+; cannot reuse those bytes while handlers (or a deferred wrap) still read
+; them. Lines that wrap, continue a partial rx_line or overflow are copied
+; by _try_read_line_nodrain as before, with rx_ptr = rx_line.
+; Mid-line CRs stay in a zero-copy line (the copy path drops them); IRC
+; forbids bare CR inside a message.
+; A trusted LF index gives the line end without CPIR, and with no whole line
+; queued the partial stays in the ring (returns 0, rx_pos stays 0), so
+; refills in process_irc_data() do not rescan it.
+; -----------------------------------------------------------------------------
+_try_read_line_zc:
+    call rx_zc_commit
+IFDEF ST_RECORD
+    jr trzc_copy            ; the recorder still has to save the CR/LF bytes
+ENDIF
+IFDEF ST_BANK128
+    ld a, (_bank_ok)
+    or a
+    jr nz, trzc_copy        ; bank lines are copied through bank_bounce
+ENDIF
+trzc_next:
+    ld hl, (_rx_pos)
+    ld a, (_rx_overflow)
+    or h
+    or l
+    jr nz, trzc_copy        ; rx_line holds a partial or overflowing line
+    call lfq_line
+    jr c, trzc_ring         ; index untrusted: CPIR for the LF
+    jr z, trzc_wait
+    or a
+    sbc hl, de
+    jr c, trzc_copy         ; the line wraps: LDIR it into rx_line
+    add hl, de
+    ld bc, _ring_buffer
+    add hl, bc
+    inc hl                  ; HL = byte after the LF
+    ex de, hl
+    add hl, bc
+    ex de, hl               ; DE = line start; CF=0 from ADD HL
+    jr trzc_found
+
+trzc_wait:
+    ; No whole line queued: keep the partial in the ring unless it already
+    ; exceeds rx_line, in which case the copy path starts discarding it.
+    ld hl, (_rb_head)
+    ld de, (_rb_tail)
+    or a
+    sbc hl, de
+    ld a, h
+    and RB_MASK_H
+    ld h, a
+    ld de, RX_LINE_MAX + 1
+    sbc hl, de              ; CF=0 from AND
+    jr nc, trzc_copy
+    ld l, 0
+    ret
+
+trzc_copy:
+    ld hl, _rx_line
+    ld (_rx_ptr), hl
+    jp _try_read_line_nodrain
+
+trzc_ring:
+    ld de, (_rb_tail)
+    ld hl, (_rb_head)
+    or a
+    sbc hl, de
+    ld a, h
+    and RB_MASK_H
+    ld h, a
+    or l
+    jr z, trzc_copy         ; empty: let the copy path return 0
+    ld b, h
+    ld c, l                 ; BC = bytes available
+    ld hl, RING_SIZE
+    sbc hl, de              ; CF=0 from OR; HL = bytes before the wrap
+    sbc hl, bc
+    jr nc, trzc_scan        ; available bytes end before the wrap
+    add hl, bc
+    ld b, h
+    ld c, l                 ; BC = bytes before the wrap
+trzc_scan:
+    ld hl, _ring_buffer
+    add hl, de
+    ld d, h
+    ld e, l                 ; DE = line start
+    ld a, 0x0A
+    cpir
+    jr nz, trzc_copy        ; no LF before head or the wrap
+trzc_found:
+    ld b, h
+    ld c, l                 ; BC = byte after the LF
+    dec hl                  ; HL = LF
+    sbc hl, de              ; CF=0 from ADD HL (CPIR keeps it); HL = bytes before LF
+    jr z, trzc_skip         ; bare LF
+    add hl, de
+    dec hl
+    ld a, (hl)
+    cp 0x0D
+    jr z, trzc_len          ; HL = CR
+    inc hl                  ; HL = LF
+trzc_len:
+    or a
+    sbc hl, de              ; HL = line length
+    jr z, trzc_skip         ; CR LF only
+    ld a, l
+    sub (RX_LINE_MAX + 1) & 0xFF
+    ld a, h
+    sbc a, (RX_LINE_MAX + 1) >> 8
+    jr nc, trzc_copy        ; too long: the copy path discards it
+    ld (_rx_last_len), hl
+    add hl, de
+    ld (hl), 0              ; NUL over the CR or LF
+    ld (_rx_ptr), de
+    ld hl, (_rb_tail)
+    ld (_rx_zc_start), hl
+    call trzc_offset
+    ld (_rx_zc_next), hl
+    call lfq_pass
+    ld a, 1
+    ld (_rx_zc_held), a
+    ld l, a
+    ret
+
+trzc_skip:
+    call trzc_offset
+    ld (_rb_tail), hl
+    ld (_lfq_mark), hl
+    call lfq_pass
+    jp trzc_next
 
+; HL = (BC - _ring_buffer) & RING_MASK. ring_buffer is page aligned.
+trzc_offset:
+    ld a, b
+    sub _ring_buffer >> 8
+    and RB_MASK_H
+    ld h, a
+    ld l, c
+    ret
+
+; -----------------------------------------------------------------------------
+; void rx_line_release(void)
+; Move _rb_tail past the line try_read_line_zc handed out, unless the ring
+; was flushed or reset meanwhile (_rb_tail is no longer the line start).
+; -----------------------------------------------------------------------------
+_rx_line_release:
+rx_zc_commit:
+    ld hl, _rx_zc_held
+    ld a, (hl)
+    or a
+    ret z
+    ld (hl), 0
+    ld hl, (_rb_tail)
+    ld de, (_rx_zc_start)
+    sbc hl, de              ; CF=0 from OR A
+    ret nz
+    ld hl, (_rx_zc_next)
+    ld (_rb_tail), hl
+    ld (_lfq_mark), hl
+    ret
+
+; -----------------------------------------------------------------------------
+; uint16_t rx_ring_discard(void)
+; Critical-pressure discard (pagination_pause): drop every unread ring byte
+; and return HL = complete lines dropped, for "[n lines lost]".
+; A held zero-copy line is still being rendered (pkt_* and the MORE prompt's
+; caller point into it), so the ring is cut back to its end instead and the
+; line survives until rx_zc_commit; the LF index now has entries past the
+; new head and is marked untrusted.
+; The count and the cut share one im2_rx_busy hold, so an IM2 drain cannot
+; add bytes in between that are dropped but not counted.
+; -----------------------------------------------------------------------------
+_rx_ring_discard:
+IFDEF ST_IM2
+    ld hl, im2_rx_busy
+    inc (hl)                ; no IM2 drain between the count and the cut
+ENDIF
+    ld de, (_rb_tail)
+    ld a, (_rx_zc_held)
+    or a
+    jr z, rrd_from
+    ld de, (_rx_zc_next)    ; the held line stays: count from its end
+rrd_from:
+    ld hl, (_rb_head)
+    or a
+    sbc hl, de
+    ld a, h
+    and RB_MASK_H
+    ld b, a
+    ld c, l                 ; BC = bytes to drop
+    ld hl, RING_SIZE
+    sbc hl, de              ; CF=0 from AND; HL = bytes before the wrap
+    push de                 ; start offset
+    ex de, hl
+    ld h, b
+    ld l, c
+    or a
+    sbc hl, de              ; HL = bytes after the wrap
+    jr nc, rrd_wraps
+    ld hl, 0                ; ends before the wrap: one span of BC
+    jr rrd_count
+rrd_wraps:
+    ld b, d
+    ld c, e                 ; BC = bytes before the wrap
+rrd_count:
+    ex (sp), hl             ; HL = start offset, stack = second span
+    ld de, _ring_buffer
+    add hl, de
+    ld de, 0                ; DE = LFs
+    call rrd_lfs
+    pop bc
+    ld hl, _ring_buffer
+    call rrd_lfs
+    push de
+
+    ld a, (_rx_zc_held)
+    or a
+    jr z, rrd_all
+    ld hl, (_rx_zc_next)
+    ld (_rb_head), hl
+    ld a, 1
+    ld (_lfq_over), a
+    jr rrd_ret
+rrd_all:
+    ld hl, (_rb_head)
+    ld (_rb_tail), hl
+rrd_ret:
+IFDEF ST_IM2
+    ld hl, im2_rx_busy
+    dec (hl)
+ENDIF
+    pop hl
+    ret
+
+; DE += LFs in the BC bytes at HL (BC may be 0).
+rrd_lfs:
+    ld a, b
+    or c
+    ret z
+    ld a, 0x0A
+rrd_lfs_scan:
+    cpir
+    ret nz                  ; no more LFs in the span
+    inc de
+    jp pe, rrd_lfs_scan     ; bytes left after this LF
+    ret
+
+IFDEF ST_BANK128
+; =============================================================================
+; BANK RING (make bank128)
+; 16 KB RX staging ring in 128K RAM bank BANK_STAGE. The drain still lands
+; bytes in the resident ring; bank_pump moves them on, and the parser reads
+; lines from the bank ring. Bank BANK_STAGE is paged in at $C000 only inside
+; bank_xfer, for one copy of up to BANK_CHUNK bytes. Both rings share the
+; $C000-$FFFF window, so every copy goes through bank_bounce below it.
+; On 48K machines (or 48 BASIC, paging locked) bank_ok stays 0 and the
+; resident ring works as before; it is still the overlay execution area.
+; =============================================================================
+defc BANK_PORT   = 0x7FFD
+defc BANK_STAGE  = 6            ; uncontended on 128K/+2
+defc BANK_CHUNK  = 32
+defc BANK_MASK_H = 0x3F         ; == BANK_RING_MASK >> 8 (spectalk.h)
+
+PUBLIC _bank_setup
+PUBLIC _bank_pump
+PUBLIC _bank_discard
+
+SECTION bss_user
+; Written by CRT init before the printer buffer is zeroed.
+bank_bankm: defs 1
+
+; bank_xfer and bank_setup run with bank 0 paged out: they must sit below
+; $C000 and keep off the stack while BANK_STAGE is in. code_crt_common is
+; linked right after the CRT, ahead of all C code; make trim checks the map.
+SECTION code_crt_common
+
+; void bank_setup(void) - once, at the top of main()
+; Paging works if a byte written at $C000 with BANK_STAGE in leaves bank 0's
+; byte alone. Otherwise the byte is restored and bank_ok stays 0.
+_bank_setup:
+    ld a, (bank_bankm)
+    bit 5, a
+    ret nz                  ; paging locked (48 BASIC)
+    and 0xF8                ; keep ROM and screen bits, bank 0 at $C000
+    ld (bank_xfer_off + 1), a
+    or BANK_STAGE
+    ld (bank_xfer_on + 1), a
+    ld hl, 0xC000
+    ld e, (hl)
+    ld bc, BANK_PORT
+    out (c), a
+    ld a, e
+    cpl
+    ld (hl), a              ; lands in BANK_STAGE if paging works
+    ld a, (bank_xfer_off + 1)
+    out (c), a
+    ld a, (hl)
+    ld (hl), e              ; undo the write on a machine without paging
+    cp e
+    ret nz
+    ld a, 1
+    ld (_bank_ok), a
+    ret
+
+; Copy BC bytes HL -> DE with BANK_STAGE at $C000. Mainline DI contract;
+; an open IM2 drain window gets its EI back through im2_resume.
+bank_xfer:
+    ld (bank_xfer_len + 1), bc
+    di
+    ld bc, BANK_PORT
+bank_xfer_on:
+    ld a, 0                 ; bank_setup: BANKM | BANK_STAGE
+    out (c), a
+bank_xfer_len:
+    ld bc, 0
+    ldir
+    ld bc, BANK_PORT
+bank_xfer_off:
+    ld a, 0                 ; bank_setup: BANKM with bank 0
+    out (c), a
+IFDEF ST_IM2
+    jp im2_resume
+ENDIF
+    ret
+
+; Bounce buffer for every bank_xfer copy. It must sit below $C000 and be its
+; own: a MORE prompt pumps and discards from inside _main_newline, while a
+; BPE expansion still holds its return stack in the printer buffer scratch.
+bank_bounce:
+    defs BANK_CHUNK
+PUBLIC bank_paged_end
+bank_paged_end:
+
+SECTION code_user
+
+; A = min(A, HL)
+bank_clamp:
+    inc h
+    dec h
+    ret nz
+    cp l
+    ret c
+    ld a, l
+    ret
+
+; -----------------------------------------------------------------------------
+; void bank_pump(void)
+; Move resident ring bytes to the bank ring until one is empty or the other
+; full. Only advances _rb_tail, so an IM2 drain may push meanwhile.
+; -----------------------------------------------------------------------------
+_bank_pump:
+    ld a, (_bank_ok)
+    or a
+    ret z
+bank_pump_loop:
+    ld de, (_rb_tail)
+    ld hl, (_rb_head)
+    or a
+    sbc hl, de
+    ld a, h
+    and RB_MASK_H
+    ld h, a                 ; HL = resident ring bytes
+    ld a, BANK_CHUNK
+    call bank_clamp
+    ld hl, RING_SIZE
+    or a
+    sbc hl, de              ; HL = bytes before the resident ring wraps
+    call bank_clamp
+    ld c, a
+    ld de, (_bank_head)
+    ld hl, (_bank_tail)
+    scf
+    sbc hl, de
+    ld a, h
+    and BANK_MASK_H
+    ld h, a                 ; HL = free bytes in the bank ring
+    ld a, c
+    call bank_clamp
+    ld hl, 0x4000
+    or a
+    sbc hl, de              ; HL = bytes before the bank ring wraps
+    call bank_clamp
+    or a
+    ret z
+    ld c, a
+    ld b, 0
+    ld hl, (_rb_tail)
+    ld de, _ring_buffer
+    add hl, de
+    ld de, bank_bounce
+    ldir
+    ld a, e
+    sub bank_bounce & 0xFF
+    ld c, a                 ; BC = chunk length again
+    ld hl, (_bank_head)
+    push hl
+    ld a, h
+    or 0xC0
+    ld d, a
+    ld e, l                 ; DE = $C000 + bank head
+    ld hl, bank_bounce
+    push bc
+    call bank_xfer
+    pop bc
+    pop hl
+    add hl, bc
+    ld a, h
+    and BANK_MASK_H
+    ld h, a
+    ld (_bank_head), hl
+    ld hl, (_rb_tail)
+    add hl, bc
+    ld a, h
+    and RB_MASK_H
+    ld h, a
+    ld (_rb_tail), hl
+    jr bank_pump_loop
+
+; -----------------------------------------------------------------------------
+; uint16_t bank_discard(void)
+; Critical discard of the bank ring (pagination_pause): empties it BANK_CHUNK
+; bytes at a time through bank_bounce and returns HL = LFs dropped, so the
+; "[n lines lost]" count covers the bank as well as ring_buffer.
+; -----------------------------------------------------------------------------
+_bank_discard:
+    ld hl, 0
+bdis_loop:
+    push hl                 ; LFs so far
+    ld de, (_bank_tail)
+    ld hl, (_bank_head)
+    or a
+    sbc hl, de
+    ld a, h
+    and BANK_MASK_H
+    ld h, a                 ; HL = bytes in the bank ring
+    ld a, BANK_CHUNK
+    call bank_clamp
+    ld hl, 0x4000
+    or a
+    sbc hl, de              ; HL = bytes before the bank ring wraps
+    call bank_clamp
+    pop hl
+    or a
+    ret z
+    push hl
+    ld c, a
+    ld b, 0
+    push bc
+    ex de, hl
+    ld a, h
+    or 0xC0
+    ld h, a                 ; HL = $C000 + bank tail
+    ld de, bank_bounce
+    call bank_xfer
+    pop bc                  ; BC = chunk length
+    ld hl, (_bank_tail)
+    add hl, bc
+    ld a, h
+    and BANK_MASK_H
+    ld h, a
+    ld (_bank_tail), hl
+    pop de                  ; DE = LFs so far
+    ld hl, bank_bounce
+    ld a, 0x0A
+bdis_scan:
+    cpir
+    jr nz, bdis_next        ; no more LFs in the chunk
+    inc de
+    jp pe, bdis_scan        ; bytes left after this LF
+bdis_next:
+    ex de, hl
+    jr bdis_loop
+
+; -----------------------------------------------------------------------------
+; _try_read_line_nodrain, bank ring version (bank_ok != 0)
+; Pumps, then copies BANK_CHUNK bytes at a time into bank_bounce and runs the
+; same CR/LF/overflow rules as trln_loop. _bank_tail only moves past bytes
+; that were consumed, so a line ending mid-chunk leaves the rest in the bank.
+; -----------------------------------------------------------------------------
+trln_bank:
+    ld hl, (_rx_pos)
+    ld de, _rx_line
+    add hl, de
+    ex de, hl               ; DE = &rx_line[rx_pos]
+trlb_refill:
+    push de
+    call _bank_pump
+    ld de, (_bank_tail)
+    ld hl, (_bank_head)
+    or a
+    sbc hl, de
+    ld a, h
+    and BANK_MASK_H
+    ld h, a                 ; HL = bytes in the bank ring
+    ld a, BANK_CHUNK
+    call bank_clamp
+    ld hl, 0x4000
+    or a
+    sbc hl, de              ; HL = bytes before the bank ring wraps
+    call bank_clamp
+    or a
+    jr z, trlb_return_0
+    ld c, a
+    ld b, 0
+    ex de, hl
+    ld a, h
+    or 0xC0
+    ld h, a                 ; HL = $C000 + bank tail
+    ld de, bank_bounce
+    call bank_xfer
+    ld a, e
+    sub bank_bounce & 0xFF
+    ld b, a                 ; B = bytes in bank_bounce
+    pop de
+    ld hl, bank_bounce
+
+trlb_byte:
+    ld a, (hl)
+    inc hl
+    cp 0x0D                 ; Ignorar \r
+    jr z, trlb_next
+    cp 0x0A
+    jr z, trlb_newline
+    ld c, a
+    ld a, e                 ; overflow if DE >= &_rx_line[RX_LINE_MAX]
+    sub (_rx_line + RX_LINE_MAX) & 0xFF
+    ld a, d
+    sbc a, (_rx_line + RX_LINE_MAX) >> 8
+    jr nc, trlb_overflow
+    ld a, c
+    ld (de), a
+    inc de
+trlb_next:
+    djnz trlb_byte
+    call trlb_consume
+    jr trlb_refill
+
+trlb_overflow:
+    ld a, 1
+    ld (_rx_overflow), a
+    jr trlb_next
+
+trlb_newline:
+    xor a
+    ld (de), a
+    ld a, (_rx_overflow)
+    or a
+    jr z, trlb_check_valid
+    xor a
+    ld (_rx_overflow), a
+    push hl
+    call rx_lost_line
+    pop hl
+    ld de, _rx_line
+    jr trlb_next
+
+trlb_check_valid:
+    push hl
+    ex de, hl
+    ld de, _rx_line
+    or a
+    sbc hl, de              ; HL = line length
+    ex de, hl
+    pop hl
+    ld a, d
+    or e
+    jr z, trlb_empty        ; Ignore empty lines
+    ld (_rx_last_len), de
+    call trlb_consume
+    ld hl, 0
+    ld (_rx_pos), hl
+    ld l, 1
+    ret
+
+trlb_empty:
+    ld de, _rx_line
+    jr trlb_next
+
+trlb_return_0:
+    pop hl                  ; HL = rx_line write pointer
+    ld de, _rx_line
+    or a
+    sbc hl, de
+    ld (_rx_pos), hl
+    ld l, 0
+    ret
+
+; _bank_tail += HL - bank_bounce (bytes of the chunk consumed)
+trlb_consume:
+    ld a, l
+    sub bank_bounce & 0xFF
+    ld hl, (_bank_tail)
+    add a, l
+    ld l, a
+    adc a, h
+    sub l
+    and BANK_MASK_H
+    ld h, a
+    ld (_bank_tail), hl
+    ret
+ENDIF
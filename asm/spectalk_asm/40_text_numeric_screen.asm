@@ -79,6 +79,211 @@ irc_tolower:
     add a, 32
     ret
 
+; -----------------------------------------------------------------------------
+; uint8_t irc_hash(const char *s) __z88dk_fastcall
+; 8-bit name hash for channels[].hash, ignore_hash[] and friend_hash[].
+; Folds with OR 0x20, coarser than irc_tolower, so st_stricmp-equal names
+; always hash equal. Stops at the first byte <= ' ' (NUL or a NAMES
+; separator) and leaves its address in irc_hash_end. Never returns 0, so 0
+; marks an empty friend slot.
+; Input: HL = string. Output: L = hash. Preserva: B, DE, IY
+; -----------------------------------------------------------------------------
+_irc_hash:
+    ld c, 0
+ihash_loop:
+    ld a, (hl)
+    cp '!'
+    jr c, ihash_end
+    or 0x20
+    xor c
+    rlca
+    ld c, a
+    inc hl
+    jr ihash_loop
+ihash_end:
+    ld (_irc_hash_end), hl
+    ld a, c
+    or a
+    jr nz, ihash_ret
+    inc a
+ihash_ret:
+    ld l, a
+    ret
+
+; -----------------------------------------------------------------------------
+; uint8_t hl_match(const char *txt) __z88dk_fastcall
+; Mention test: 1 if irc_nick or a highlight_words entry occurs in txt as a
+; whole word (no nick char on either side, so "bob" misses "bobby").
+; Horspool over hl_tab (built by hl_compile): the byte at the window end
+; gives the shift through its (c & 31) bucket. Shift 0 checks the
+; first-char bit at the window start, then the words with irc_tolower.
+; Input: HL = txt. Output: L = 0/1. Preserva: IY
+; -----------------------------------------------------------------------------
+_hl_match:
+    ld a, (_hl_min)
+    or a
+    jr z, hlm_none          ; no words
+    ld (hlm_start), hl
+    ld e, a
+    xor a
+    ld b, a
+    ld c, a
+    cpir                    ; HL = NUL + 1
+    dec hl
+    dec hl
+    ld b, h
+    ld c, l                 ; BC = last byte of txt
+    ld hl, (hlm_start)
+    ld d, 0
+    dec e
+    add hl, de
+    ex de, hl               ; DE = first window end (txt + m - 1)
+    xor a
+    jr hlm_step
+
+hlm_scan:
+    ld a, (de)
+    and 31
+    ld hl, _hl_tab
+    add a, l
+    ld l, a
+    jr nc, hlm_tab
+    inc h
+hlm_tab:
+    ld a, (hl)
+    and 0x3F
+    jr z, hlm_verify
+hlm_step:
+    add a, e
+    ld e, a
+    jr nc, hlm_bound
+    inc d
+hlm_bound:
+    ld h, b
+    ld l, c
+    or a
+    sbc hl, de
+    jr nc, hlm_scan         ; window end <= last byte
+hlm_none:
+    ld l, 0
+    ret
+
+hlm_verify:
+    push bc
+    push de
+    ld a, (_hl_min)
+    dec a
+    ld c, a
+    ld b, 0
+    ex de, hl
+    or a
+    sbc hl, bc              ; HL = window start
+    ld a, (hl)
+    and 31
+    ld c, a
+    ex de, hl
+    ld hl, _hl_tab
+    add hl, bc
+    bit 7, (hl)
+    jr z, hlm_miss          ; no word starts with this byte
+    ld hl, (hlm_start)
+    or a
+    sbc hl, de
+    jr z, hlm_left_ok       ; window starts the text
+    dec de
+    ld a, (de)
+    inc de
+    call hlm_isword
+    jr c, hlm_miss
+hlm_left_ok:
+    ex de, hl               ; HL = window start
+    ld de, _irc_nick
+    call hlm_word
+    jr z, hlm_hit
+    ld de, _highlight_words
+hlm_list:
+    ld a, (de)
+    or a
+    jr z, hlm_miss
+    call hlm_word
+    jr z, hlm_hit
+    ld a, (de)
+    or a
+    jr z, hlm_miss
+    inc de                  ; skip ','
+    jr hlm_list
+hlm_miss:
+    pop de
+    pop bc
+    ld a, 1
+    jr hlm_step
+hlm_hit:
+    pop de
+    pop bc
+    ld l, 1
+    ret
+
+; HL = text, DE = word (ends at ',' or NUL). Z = whole-word match.
+; DE is left on the word's terminator. Preserva: HL
+hlm_word:
+    push hl
+    ld a, (de)
+    or a
+    jr z, hlw_fail
+    cp ','
+    jr z, hlw_fail          ; empty word
+hlw_cmp:
+    call irc_tolower
+    ld c, a
+    ld a, (hl)
+    call irc_tolower
+    cp c
+    jr nz, hlw_skip
+    inc hl
+    inc de
+    ld a, (de)
+    or a
+    jr z, hlw_end
+    cp ','
+    jr nz, hlw_cmp
+hlw_end:
+    ld a, (hl)              ; byte after the word
+    call hlm_isword
+    jr c, hlw_fail
+    xor a
+    pop hl
+    ret
+hlw_skip:
+    inc de
+    ld a, (de)
+    or a
+    jr z, hlw_fail
+    cp ','
+    jr nz, hlw_skip
+hlw_fail:
+    or 1
+    pop hl
+    ret
+
+; A = byte. CF = 1 if it can be part of a nick: letters, digits,
+; []\`_^{|} and '-'.
+hlm_isword:
+    cp '-'
+    scf
+    ret z
+    sub '0'
+    cp 10
+    ret c
+    sub 'A' - '0'
+    cp '}' - 'A' + 1
+    ret
+
+SECTION bss_user
+; Not CRT-zeroed: set on every hl_match() entry.
+hlm_start: defs 2           ; hl_match() txt, for the left word boundary
+
+SECTION code_user
+
 ; -----------------------------------------------------------------------------
 ; const char* st_stristr(const char *hay, const char *needle) __z88dk_callee
 ; B?squeda case-insensitive de substring
@@ -448,6 +653,21 @@ DRAIN_UART_STAT_REG     EQU 0xC7
 DRAIN_UART_BYTE_RECIVED EQU 0x80
 
 _uart_drain_to_buffer:
+IFDEF ST_PASSIVE
+    ld a, (_esp_passive)
+    or a
+    jp nz, _esp_pull        ; passive link: ask the ESP for what fits
+_uart_drain_raw:
+ENDIF
+IFDEF ST_IM2
+    ld hl, im2_rx_busy
+    inc (hl)                ; keep the IM2 drain out while this one runs
+    call uart_drain_locked
+    ld hl, im2_rx_busy
+    dec (hl)
+    ret
+uart_drain_locked:
+ENDIF
     ld a, (_uart_drain_limit)
     or a
     jr nz, drain_set_limit
@@ -460,6 +680,13 @@ drain_set_limit:
     exx
     ld hl, (_rb_head)
     ld de, (_rb_tail)
+IFDEF ST_RECORD
+    ld b, d
+    ld c, e
+    call rec_floor_bc       ; DE' = rec_tail while !record has unwritten bytes
+    ld d, b
+    ld e, c
+ENDIF
     exx                     ; HL'=head offset, DE'=tail offset
     ld d, a                 ; D = remaining byte budget
     ld e, 0                 ; E = 1 once this call has pushed at least one byte
@@ -488,6 +715,7 @@ drain_read_ready:
     ld c, l                 ; BC = current head offset
     inc hl
     res 3, h                ; future head = (head + 1) & 0x07FF
+drain_push_check:
     or a
     sbc hl, de              ; full if future head == tail
     add hl, de              ; restore future head; Z preserved
@@ -496,6 +724,8 @@ drain_read_ready:
     ld hl, _ring_buffer
     add hl, bc              ; HL = &_ring_buffer[current head]
     ld (hl), a
+    cp 0x0A
+    call z, lfq_add         ; index the LF at BC' (HL' is on the stack)
     pop hl                  ; HL' = future head
     exx
     dec b                   ; port back to $FC3B for the next status select
@@ -505,6 +735,14 @@ drain_read_ready:
     jr drain_commit_ret
 
 drain_ring_full:
+IFDEF ST_RECORD
+    call rec_give_up        ; CF=1: recorder released parsed bytes, retry
+    ld de, (_rb_tail)
+    jr c, drain_push_check
+ENDIF
+    ld hl, (_rx_stats + RXS_FULL)
+    inc hl
+    ld (_rx_stats + RXS_FULL), hl
     ld h, b
     ld l, c                 ; restore uncommitted current head
     exx
@@ -537,6 +775,18 @@ drain_exit_empty:
 drain_commit_ret:
     exx
     ld (_rb_head), hl
+    ; rx_stats.peak = max(peak, (head - tail) & RING_MASK); DE' = tail.
+    or a
+    sbc hl, de
+    ld a, h
+    and RING_MASK >> 8      ; also clears carry for the compare
+    ld h, a
+    ld de, (_rx_stats + RXS_PEAK)
+    sbc hl, de
+    jr c, drain_peak_done
+    add hl, de
+    ld (_rx_stats + RXS_PEAK), hl
+drain_peak_done:
     exx
     ret
 
@@ -551,6 +801,19 @@ drain_commit_ret:
 ; until measured on the target emulator/hardware.
 ; =============================================================================
 _scroll_main_zone:
+IFDEF ST_TRACE
+    ld hl, (_rb_head)
+    ld de, (_rb_tail)
+    or a
+    sbc hl, de
+    ld a, h
+    and 0x07                ; RING_BUFFER_MASK >> 8
+    ld h, a
+    ld a, TR_SCROLL
+    call trace_rec          ; arg = ring backlog before the >100k T blit
+ENDIF
+    ld hl, _scroll_count
+    inc (hl)                ; process_irc_data charges each scroll to its batch
     di
 
     ld iyl, 7              ; IYL = scanline offset (7..0)
@@ -655,6 +918,9 @@ smz_clear19_px:
     push de
 smz_clear_save_sp:
     ld sp, 0x0000
+IFDEF ST_IM2
+    call im2_resume         ; SP is back: EI again inside a drain window
+ENDIF
     ret
 
 ; Cross-page scroll helper: copies 32 bytes from page A to page A-8
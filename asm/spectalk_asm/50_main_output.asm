@@ -2,6 +2,7 @@
 
 EXTERN _ignore_count
 EXTERN _ignore_list
+EXTERN _ignore_hash
 
 EXTERN _show_timestamps
 EXTERN _wrap_indent
@@ -1003,6 +1004,7 @@ puts_opt_done:
 ; -----------------------------------------------------------------------------
 ; uint8_t is_ignored(const char *nick) __z88dk_fastcall
 ; Verifica si un nick est? en la lista de ignorados (Array de 16 bytes stride).
+; CPIR over ignore_hash[] (irc_hash per entry); st_stricmp only on a hash hit.
 ; HL = nick
 ; Retorna L=1 (true) o L=0 (false)
 ; -----------------------------------------------------------------------------
@@ -1011,54 +1013,53 @@ _is_ignored:
     ld a, (_ignore_count)
     or a
     jr z, ign_fail      ; Si count == 0, retornar 0
-    
-    ld b, a             ; B = contador de bucle
-    ld de, _ignore_list ; DE = puntero al inicio de la lista
-    ld a, (hl)
-    or 0x20
-    ld c, a             ; C = first char folded like RFC1459 ASCII subset
-    
-ign_loop:
-    ld a, (de)
-    or 0x20
-    cp c
-    jr nz, ign_skip
 
-    ; Guardar contexto
+    push iy
+    push hl
+    pop iy              ; IY = nick
+    call _irc_hash      ; L = hash
+    ld a, (_ignore_count)
+    ld c, a
+    ld b, 0             ; BC = entradas por mirar
+    ld a, l
+    ld hl, _ignore_hash
+
+ign_scan:
+    cpir
+    jr nz, ign_fail_iy
+    push af
     push bc
-    push de
     push hl
-    
-    ; Preparar llamada a st_stricmp(list_item, nick)
-    ; Convenci?n C (stack): push right-to-left
-    push hl             ; Arg2: nick
-    push de             ; Arg1: list_item
-    call _st_stricmp
-    
-    ; Resultado en HL. Si es 0, hay coincidencia.
-    ld a, h
-    or l
-    ; Restaurar contexto
-    pop hl              ; nick
-    pop de              ; list_ptr actual
-    pop bc              ; contador
-    jr nz, ign_skip
-    ld l, 1
-    ret
-    
-ign_skip:
-    ; Avanzar DE + 16 (tama?o fijo de cada entrada en ignore_list)
-    ld a, e
-    add a, 16
+    ld a, (_ignore_count)
+    dec a
+    sub c               ; A = index of the hash hit
+    add a, a
+    add a, a
+    add a, a
+    add a, a            ; * 16 (MAX_IGNORES * 16 < 256)
     ld e, a
-    jr nc, ign_next
-    inc d
-    
-ign_next:
-    djnz ign_loop       ; Siguiente iteraci?n
-    
+    ld d, 0
+    ld hl, _ignore_list
+    add hl, de          ; HL = ignore_list[index]
+    call fc_check_name  ; Z = st_stricmp(entry, nick) == 0
+    pop hl
+    pop bc
+    jr z, ign_yes
+    pop af
+    ld d, a
+    ld a, b
+    or c
+    ld a, d
+    jr nz, ign_scan     ; CPIR with BC = 0 would scan 64K
+ign_fail_iy:
+    pop iy
 ign_fail:
     ld l, 0
     ret
+ign_yes:
+    pop af
+    pop iy
+    ld l, 1
+    ret
 
 
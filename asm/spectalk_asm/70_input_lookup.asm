@@ -2,21 +2,32 @@
 ; UTF-8 to ASCII + IRC control cleanup.
 ; Cubre Latin-1 Supplement (C2 80-BF, C3 80-BF) = codepoints 0080-00FF
 ; and falls back for single-byte Latin-1/CP1252 accents from old IRC clients.
+; The line is already in place (ring or rx_line), so this is the only pass
+; over the text: a leading run of printable ASCII is skipped without writes,
+; and later printable bytes take a short path past the control checks.
 ; =============================================================================
 PUBLIC _utf8_to_ascii
 
 _utf8_to_ascii:
     push hl                 ; Guardar inicio para retornar
+u8a_scan:
+    ld a, (hl)
+    cp 0x20
+    jr c, u8a_scan_end      ; NUL or IRC control
+    cp 0x80
+    jr nc, u8a_scan_end     ; UTF-8/Latin-1: start rewriting here
+    inc hl
+    jr u8a_scan
+u8a_scan_end:
     ld d, h
     ld e, l                 ; DE = escritura, HL = lectura
 
 u8a_loop:
     ld a, (hl)
-    or a
-    jr z, u8a_done
-    
+    cp 0x20
+    jp c, u8a_ctrl          ; 00-1F: NUL or IRC control
     cp 0x80
-    jp c, u8a_copy          ; 00-7F: ASCII
+    jp c, u8a_plain         ; 20-7F: ASCII
 
     cp 0xC0
     jp c, u8a_skip1         ; 80-BF: orphan continuation/C1 controls
@@ -111,7 +122,9 @@ u8a_skip1:
     inc hl
     jr u8a_store_q
 
-u8a_copy:
+u8a_ctrl:
+    or a
+    jp z, u8a_done
     cp 0x02                 ; IRC bold
     jr z, u8a_ascii_skip
     cp 0x0F                 ; IRC reset
@@ -122,6 +135,7 @@ u8a_copy:
     jr z, u8a_ascii_skip
     cp 0x03                 ; IRC color
     jr z, u8a_color
+u8a_plain:
     ld (de), a
     inc de
 u8a_ascii_skip:
@@ -621,6 +635,7 @@ _print_char64:
 ; =============================================================================
 ; int8_t find_channel(const char *name) __z88dk_fastcall
 ; Search active channels[] by IRC case-insensitive name. Returns slot or -1.
+; Slots whose cached hash differs from irc_hash(name) skip the st_stricmp.
 ; HL = name pointer
 ; Returns: L = slot index (0..N) or 0xFF (-1)
 ; =============================================================================
@@ -631,12 +646,15 @@ EXTERN _st_stricmp
 
 DEFC FC_CH_SIZE = 32
 DEFC FC_FLAGS_OFS = 30
+DEFC FC_HASH_OFS = 31
 DEFC FC_FLAG_ACTIVE = 0x01
 
 _find_channel:
     push iy
     push hl
     pop iy                       ; IY = target name
+    call _irc_hash
+    ld c, l                      ; C = target hash
 
     ld de, _channels
     ld b, 0                      ; B = slot index
@@ -647,11 +665,13 @@ fc_loop:
     cp (hl)
     jr nc, fc_ret_neg1
 
-    push de
-    ld hl, FC_FLAGS_OFS
+    ld hl, FC_HASH_OFS
     add hl, de
     ld a, (hl)
-    pop de
+    cp c
+    jr nz, fc_next
+    dec hl                       ; HL = &ch->flags
+    ld a, (hl)
     and FC_FLAG_ACTIVE
     jr z, fc_next
 
@@ -692,46 +712,30 @@ fc_check_name:
 ; =============================================================================
 ; uint8_t is_tracked_friend(const char *nick) __z88dk_fastcall
 ; HL = nick pointer. Returns L = 1 when nick is in friend_nicks[], else 0.
+; friend_hash[] holds irc_hash() per slot, 0 for an empty slot.
 ; =============================================================================
 PUBLIC _is_tracked_friend
 EXTERN _friend_count
 EXTERN _friend_nicks
+EXTERN _friend_hash
 
-DEFC ITF_MAX_FRIENDS = 5
-DEFC ITF_NICK_SIZE = 18
-
-; uint8_t friend_initial_match(char c) __z88dk_fastcall
-; HL fastcall low byte holds c. Returns L=1 if any configured friend has same
-; folded first byte, else L=0. Used to avoid token mutation/casefold compare
-; for almost all NAMES nicks.
-PUBLIC _friend_initial_match
-_friend_initial_match:
-    ld a, (_friend_count)
-    or a
-    jr z, fim_no
-    ld b, a
-    ld a, l
-    or 0x20
-    ld c, a
-    ld de, _friend_nicks
-fim_loop:
-    ld a, (de)
-    or a
-    jr z, fim_next
-    or 0x20
-    cp c
-    jr z, fim_yes
-fim_next:
-    ld hl, ITF_NICK_SIZE
-    add hl, de
-    ex de, hl
-    djnz fim_loop
-fim_no:
-    ld l, 0
-    ret
-fim_yes:
-    ld l, 1
-    ret
+DEFC ITF_MAX_FRIENDS = 5
+DEFC ITF_NICK_SIZE = 18
+
+; uint8_t friend_hash_hit(uint8_t h) __z88dk_fastcall
+; L = irc_hash() of a nick. Returns L=1 if a friend slot has that hash, else
+; L=0. Lets the NAMES scan hash each nick once, while it skips it, and only
+; cut and compare the rare hits.
+PUBLIC _friend_hash_hit
+_friend_hash_hit:
+    ld a, l
+    ld hl, _friend_hash
+    ld bc, ITF_MAX_FRIENDS
+    cpir
+    ld l, 0
+    ret nz
+    inc l
+    ret
 
 _is_tracked_friend:
     ld a, (_friend_count)
@@ -747,40 +751,46 @@ _is_tracked_friend:
     push iy
     push hl
     pop iy                       ; IY = nick
-    or 0x20
-    ld c, a                      ; C = nick[0] folded like the C helper
-
-    ld b, ITF_MAX_FRIENDS
-    ld de, _friend_nicks
-itf_loop:
-    ld a, (de)
-    or a
-    jr z, itf_next
-    or 0x20
-    cp c
-    jr nz, itf_next
-
-    push de
+    call _irc_hash
+    ld a, l                      ; A = nick hash
+    ld hl, _friend_hash
+    ld bc, ITF_MAX_FRIENDS
+
+itf_scan:
+    cpir
+    jr nz, itf_no_iy
+    push af
     push bc
-    push iy
-    push de
-    call _st_stricmp
-    ld a, l
-    or h
+    push hl
+    ld a, ITF_MAX_FRIENDS - 1
+    sub c                        ; A = slot of the hash hit
+    ld e, a
+    add a, a
+    add a, a
+    add a, a
+    add a, e                     ; * 9
+    add a, a                     ; * ITF_NICK_SIZE
+    ld e, a
+    ld d, 0
+    ld hl, _friend_nicks
+    add hl, de
+    call fc_check_name           ; Z = st_stricmp(friend, nick) == 0
+    pop hl
     pop bc
-    pop de
     jr z, itf_yes
-
-itf_next:
-    ld hl, ITF_NICK_SIZE
-    add hl, de
-    ex de, hl
-    djnz itf_loop
+    pop af
+    ld d, a
+    ld a, c                      ; B = 0: at most ITF_MAX_FRIENDS left
+    or a
+    ld a, d
+    jr nz, itf_scan
+itf_no_iy:
     pop iy
 itf_no:
     ld l, 0
     ret
 itf_yes:
+    pop af
     pop iy
     ld l, 1
     ret
@@ -922,6 +932,7 @@ EXTERN _S_GLOBAL
 
 DEFC FQ_CH_SIZE = 32
 DEFC FQ_FLAGS_OFS = 30
+DEFC FQ_HASH_OFS = 31
 DEFC FQ_FLAG_ACTIVE = 0x01
 DEFC FQ_FLAG_QUERY = 0x02
 
@@ -978,6 +989,11 @@ fq_check_server:
     jr z, fq_ret_a_iy
 
 fq_loop_init:
+    push iy
+    pop hl
+    call _irc_hash
+    ld c, l             ; C = nick hash, compared before st_stricmp
+
     ; Loop: for i=1; i < channel_count; i++
     ; DE = &channels[1] = channels + 32
     ld de, _channels + FQ_CH_SIZE
@@ -989,13 +1005,15 @@ fq_loop:
     cp (hl)
     jr nc, fq_ret_neg1_iy ; i >= channel_count
 
+    ld hl, FQ_HASH_OFS
+    add hl, de          ; HL = &ch->hash
+    ld a, (hl)
+    cp c
+    jr nz, fq_next
+
     ; Check flags: (ch->flags & (ACTIVE|QUERY)) == (ACTIVE|QUERY)
-    ; flags at offset 30 from DE
-    push de             ; save ch base
-    ld hl, FQ_FLAGS_OFS
-    add hl, de          ; HL = &ch->flags
+    dec hl              ; HL = &ch->flags
     ld a, (hl)
-    pop de              ; restore ch base
     and FQ_FLAG_ACTIVE | FQ_FLAG_QUERY
     cp FQ_FLAG_ACTIVE | FQ_FLAG_QUERY
     jr nz, fq_next
@@ -735,6 +735,7 @@ homm_yes:
 ; - size bucket: >=2048 users -> 4 quits, >=1024 -> 8,
 ;   >=256 -> 16, smaller -> 32.
 ; - each extra open channel above two adds one quit to the threshold.
+; - never while another silent LIST is still in flight (list_auto_chan).
 PUBLIC _count_sync_tick
 EXTERN _connection_state
 EXTERN _line_len
@@ -744,11 +745,15 @@ EXTERN _buffer_pressure
 EXTERN _count_sync_enabled
 EXTERN _count_sync_idle_frames
 EXTERN _count_sync_quits
-EXTERN _irc_send_cmd1
+EXTERN _list_auto_chan
+EXTERN _list_auto_send
 _count_sync_tick:
     ld a, (_count_sync_enabled)
     or a
     ret z
+    ld a, (_list_auto_chan)
+    or a
+    ret nz
     ld a, (_connection_state)
     cp 3                        ; STATE_IRC_READY
     ret nz
@@ -846,20 +851,13 @@ cst_have_threshold:
     ld (_count_sync_quits), a
     inc hl                      ; HL was at user_count MSB, now flags
     res 5, (hl)                 ; clear CH_FLAG_COUNT_DIRTY
-    ld hl, (_cur_chan_ptr)      ; channel name is at offset 0
-    push hl
-    ld hl, cst_list_cmd
-    push hl
-    call _irc_send_cmd1
-    ret
+    ld hl, (_current_channel_idx)
+    jp _list_auto_send          ; LIST #current, tagged by name
 cst_reset_idle:
     xor a
     ld (_count_sync_idle_frames), a
     ret
 
-cst_list_cmd:
-    DEFM "LIST", 0
-
 ; =============================================================================
 ; FRAME WAIT ? Wait for next frame (50Hz sync via IM1 ROM ISR)
 ; ROM ISR at $0038 increments FRAMES (23672) and scans keyboard.
@@ -874,6 +872,9 @@ _frame_wait:
     halt                ; wait for next frame interrupt (exact 50Hz)
     di
     pop iy              ; restore IY for SDCC
+IFDEF ST_IM2
+    call im2_resume     ; EI again inside an IM2 drain window
+ENDIF
     ret
 
 ; Resident-safe frame wait that drains UART while waiting for the next ROM frame.
@@ -895,7 +896,143 @@ fwd_loop:
     pop bc
     di
     pop iy
+IFDEF ST_IM2
+    call im2_resume
+ENDIF
+    ret
+
+IFDEF ST_IM2
+; =============================================================================
+; IM2 FRAME DRAIN (make im2)
+; While process_irc_data() holds a drain window open, the frame interrupt
+; also moves up to IM2_DRAIN_BUDGET UART bytes into ring_buffer, so long
+; renders (wrapped lines, NAMES grids) do not starve the UART FIFO. Outside
+; the window the machine is back in IM1 under the mainline DI contract.
+;
+; Vector: I = $39 points into the 48K ROM's $FF fill ($386E-$3CFF), so any
+; bus byte vectors to $FFFF. $FFFF holds JR; its offset is the ROM's DI ($F3)
+; at $0000, which lands on the JP at $FFF4. $FFF2-$FFFF lie above the UDG
+; block and away from the BSS and the ring. im2_setup() checks those ROM
+; bytes and leaves im2_ok = 0 (polling only) on any other ROM.
+;
+; The handler saves IY and loads $5C3A before it chains into the ROM ISR, so
+; IYL users (print_line64_fast) are safe with EI inside a window. Routines
+; that move SP (scroll, cls_fast, notif_clear) still DI; scroll_main_zone
+; and frame_wait call im2_resume to EI again while a window is open.
+; =============================================================================
+defc IM2_TABLE_PAGE   = 0x39
+defc IM2_JP_ADDR      = 0xFFF4
+defc IM2_JR_ADDR      = 0xFFFF
+defc IM2_DRAIN_BUDGET = 64      ; bytes per frame, about a quarter of 115200 baud
+
+PUBLIC _im2_setup
+PUBLIC _im2_window_open
+PUBLIC _im2_window_close
+PUBLIC im2_resume
+PUBLIC im2_rx_busy
+
+SECTION bss_user
+; Not CRT-zeroed: im2_setup() writes all three before IM2 can start.
+im2_ok:      defs 1   ; 1 = stock 48K ROM vector bytes found
+im2_window:  defs 1   ; 1 = drain window open (IM2 + EI)
+im2_rx_busy: defs 1   ; > 0 while the mainline drains or talks to the UART
+SECTION code_user
+
+; void im2_setup(void) - once, at the top of main()
+_im2_setup:
+    xor a
+    ld (im2_ok), a
+    ld (im2_window), a
+    ld (im2_rx_busy), a
+    ld a, (0x0000)
+    cp 0xF3                 ; DI: the JR offset read at $0000
+    ret nz
+    ld hl, IM2_TABLE_PAGE * 256
+    ld b, 0                 ; 256 bytes, then $3A00 below
+im2_setup_scan:
+    ld a, (hl)
+    inc a
+    ret nz
+    inc hl
+    djnz im2_setup_scan
+    ld a, (hl)
+    inc a
+    ret nz
+    ld a, 0x18              ; JR $FFF4 (offset $F3 from the ROM)
+    ld (IM2_JR_ADDR), a
+    ld a, 0xC3              ; JP im2_isr
+    ld (IM2_JP_ADDR), a
+    ld hl, im2_isr
+    ld (IM2_JP_ADDR + 1), hl
+    ld a, IM2_TABLE_PAGE
+    ld i, a
+    ld a, 1
+    ld (im2_ok), a
+    ret
+
+; void im2_window_open(void) - IM2 + EI; no-op without im2_ok
+_im2_window_open:
+    ld a, (im2_ok)
+    or a
+    ret z
+    ld (im2_window), a
+    im 2
+    ei
+    ret
+
+; void im2_window_close(void) - DI + IM1: back to the mainline DI contract
+_im2_window_close:
+    di
+    im 1
+    xor a
+    ld (im2_window), a
+    ret
+
+; EI again after a DI section if a window is open. Preserves all registers.
+im2_resume:
+    push af
+    ld a, (im2_window)
+    or a
+    jr z, im2_resume_ret
+    ei
+im2_resume_ret:
+    pop af
+    ret
+
+im2_isr:
+    push af
+    push bc
+    push de
+    push hl
+    exx
+    push bc
+    push de
+    push hl
+    exx
+    push iy
+    ld iy, 0x5C3A           ; ROM ISR expects IY = system variables
+    ld a, (im2_rx_busy)
+    or a
+    jr nz, im2_isr_rom      ; mainline owns the UART ports or ring head
+    ld a, (im2_window)
+    or a
+    jr z, im2_isr_rom
+    ld a, IM2_DRAIN_BUDGET
+    call drain_set_limit    ; _uart_drain_to_buffer body, fixed budget
+im2_isr_rom:
+    call 0x0038             ; FRAMES + keyboard; returns with EI
+    pop iy
+    exx
+    pop hl
+    pop de
+    pop bc
+    exx
+    pop hl
+    pop de
+    pop bc
+    pop af
     ret
+ENDIF
 
 ; =============================================================================
 ; SYSTEM RAM HIJACKING - Variables mapped to unused ZX system areas
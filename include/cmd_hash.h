@@ -0,0 +1,33 @@
+// Generated by tools/gen_cmd_hash.py from src/cmd_table.inc.
+// Do not edit: reorder or add CMD_TABLE rows, then run make (or the script).
+#ifndef CMD_HASH_H
+#define CMD_HASH_H
+
+#define CMD_HASH_ROWS  42
+#define CMD_HOT_ID     0x5052  // CMD_TABLE[0], compared before the probe
+#define CMD_HASH_MASK  63
+#define CMD_HASH_NB    8
+#define CMD_HASH_S     1
+#define CMD_HASH_T     4
+#define CMD_HASH_U     5
+
+// Slot for cmd_id bytes (lo, hi); CMD_SLOT holds CMD_TABLE index + 1.
+#define CMD_HASH(lo, hi) ((uint8_t)((lo) + (uint8_t)((hi) << CMD_HASH_S) + \
+    CMD_DISP[(uint8_t)((lo) ^ (uint8_t)((hi) << CMD_HASH_T)) >> CMD_HASH_U & (CMD_HASH_NB - 1)]) & CMD_HASH_MASK)
+
+static const uint8_t CMD_DISP[CMD_HASH_NB] = {
+     6, 30,  0,  5,  1,  6, 31,  0,
+};
+
+// PR@50 NO@49 PI@41 353@40 366@53 322@4 352@39 323@5 315@27 001@7 002@8 003@9
+// 004@10 900@16 005@11 303@15 305@17 306@18 321@3 324@6 332@14 376@63 401@20 433@57
+// 422@46 451@36 403@22 404@23 405@24 471@56 473@58 474@59 477@62 PO@47 PA@33 NI@43
+// JO@35 QU@55 KI@31 MO@42 ER@34 CA@12
+static const uint8_t CMD_SLOT[CMD_HASH_MASK + 1] = {
+     0,  0,  0, 19,  6,  8, 20, 10, 11, 12, 13, 15, 42,  0, 21, 16,
+    14, 17, 18,  0, 23,  0, 27, 28, 29,  0,  0,  9,  0,  0,  0, 39,
+     0, 35, 41, 37, 26,  0,  0,  7,  4,  3, 40, 36,  0,  0, 25, 34,
+     0,  2,  1,  0,  0,  5,  0, 38, 30, 24, 31, 32,  0,  0, 33, 22,
+};
+
+#endif
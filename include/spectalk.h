@@ -78,18 +78,26 @@
 #define AUTOJOIN_IDENT_SENT  0x04
 #define AUTOJOIN_IDENT_GRACE_FRAMES 250
 
+// cap_nin: IRCv3 draft/no-implicit-names state for this connection
+#define CAP_NIN_OFFERED      1   // listed in CAP LS, REQ pending
+#define CAP_NIN_ACTIVE       2   // ACKed: JOIN sends no 353/366
+
 #define CH_FLAG_ACTIVE     0x01
 #define CH_FLAG_QUERY      0x02
 #define CH_FLAG_UNREAD     0x04
 #define CH_FLAG_MENTION    0x08
 #define CH_FLAG_NAMING     0x10
 #define CH_FLAG_COUNT_DIRTY 0x20
+#define CH_FLAG_LISTING    0x40   // JOIN-time LIST count still due (CAP_NIN_ACTIVE)
 
 // =============================================================================
 // buffer SIZES
 // =============================================================================
 #define RING_BUFFER_SIZE 2048
 #define RING_BUFFER_MASK (RING_BUFFER_SIZE - 1)
+// LF index entries (power of 2, LFQ_MASK EQU in the ASM); 64 covers a full
+// ring of 32-byte lines before the readers fall back to scanning
+#define LFQ_SIZE 64
 #define LINE_BUFFER_SIZE 128
 
 // IRC/user-visible string sizes (must match definitions in spectalk.c)
@@ -99,6 +107,7 @@
 #define IRC_PASS_SIZE     24
 #define USER_MODE_SIZE     6
 #define NETWORK_NAME_SIZE 12
+#define HIGHLIGHT_SIZE    32   // highlight= words, ',' separated
 
 // Cross-module buffers (must match definitions in spectalk.c)
 #define NAMES_TARGET_CHANNEL_SIZE 32
@@ -123,7 +132,7 @@ typedef struct {
     char mode[6];            // Channel mode (e.g. "+nt") - only for channels
     uint16_t user_count;     // Number of users - only for channels
     uint8_t flags;           // CH_FLAG_ACTIVE | CH_FLAG_QUERY | CH_FLAG_UNREAD | ...
-    uint8_t _pad;            // Padding para alinear a 32 bytes (i*32 = shift)
+    uint8_t hash;            // irc_hash(name): find_channel/find_query test it first
 } ChannelInfo;               // TOTAL: 32 bytes (potencia de 2)
 
 // =============================================================================
@@ -143,6 +152,11 @@ typedef struct {
 #define PEND_SEARCH_CHAN  3
 #define PEND_SEARCH_USER  4
 
+// elist_caps: ISUPPORT ELIST= tokens from 005 (reset per connect)
+#define ELIST_SEEN        0x01   // server sent ELIST=
+#define ELIST_MASK        0x02   // M: LIST *mask* filters server-side
+#define ELIST_USERS       0x04   // U: LIST >N filters server-side
+
 // =============================================================================
 // TIMEOUTS (frames, HALT-based)
 // =============================================================================
@@ -157,14 +171,25 @@ typedef struct {
 // Names timeout
 #define NAMES_TIMEOUT_FRAMES 500
 
+// Silent LIST #chan reply timeout (main-loop frames)
+#define LIST_AUTO_TIMEOUT_FRAMES 150
+
 // =============================================================================
 // DRAIN LIMITS
 // =============================================================================
 #define DRAIN_NORMAL    32
 #define RX_TICK_PARSE_BYTE_BUDGET 512   // Reduced from 1024 to prevent keyboard lag during JOIN bursts
 
+// Main-loop cost estimate in 1/8-frame units (~8.7k T), counted from parsed
+// lines, bytes and scrolls. The mainline runs with DI, so FRAMES cannot see
+// this work in the polling build.
+#define RX_COST_LINE         1  // parse + dispatch, ~8k T
+#define RX_COST_SCROLL      16  // scroll_main_zone (90k T uncontended) + contention + row render
+#define RX_COST_BYTE_SHIFT   7  // plus one unit per 128 bytes
+
 // Buffer pressure thresholds
 #define BUFFER_PRESSURE_THRESHOLD (RING_BUFFER_SIZE * 3 / 4)  // 1536 bytes = 75%
+#define BUFFER_RELIEF_THRESHOLD (RING_BUFFER_SIZE / 4)        // 512 bytes: pressure clears
 #define BUFFER_CRITICAL_MARGIN 128  // Reserve 128 bytes before full
 
 // =============================================================================
@@ -217,6 +242,9 @@ extern void clear_zone(uint8_t start, uint8_t lines, uint8_t attr) __z88dk_calle
 // Compute screen row base: H = 0x40|(y&0x18), L = (y&7)<<5
 #define SCREEN_ROW_ADDR(y) ((uint16_t)(((0x40 | ((y) & 0x18)) << 8) | (((y) & 7) << 5)))
 extern int st_stricmp(const char *a, const char *b) __z88dk_callee;
+// RFC1459-folded 8-bit hash up to the first byte <= ' ' (left in irc_hash_end)
+extern uint8_t irc_hash(const char *s) __z88dk_fastcall;
+extern char *irc_hash_end;
 extern const char* st_stristr(const char *hay, const char *needle) __z88dk_callee;
 extern uint8_t st_strlen(const char *s) __z88dk_fastcall;
 extern char* u16_to_dec(char *dst, uint16_t v) __z88dk_callee;
@@ -226,6 +254,14 @@ extern void uart_send_string(const char *s) __z88dk_fastcall;
 extern int16_t rb_pop(void);
 
 extern uint8_t try_read_line_nodrain(void);
+// Zero-copy variant for process_irc_data(): the line is at rx_ptr, either in
+// ring_buffer or in rx_line. It stays valid until the next read or
+// rx_line_release(); handlers and a deferred wrap may keep pointers into it.
+extern uint8_t try_read_line_zc(void);
+extern void rx_line_release(void);
+// Critical discard: empties the ring, or cuts it back to the end of a held
+// zero-copy line so rx_ptr stays valid.
+extern uint16_t rx_ring_discard(void);  // complete lines dropped
 
 // =============================================================================
 // divMMC UART backend (legacy ay_uart_* symbol names)
@@ -245,7 +281,16 @@ extern uint16_t rb_tail;
 // Connection state
 extern char irc_server[IRC_SERVER_SIZE];
 extern char irc_port[IRC_PORT_SIZE];
+extern uint8_t irc_passive;     // passive= / bookmark flag: ask for CIPRECVMODE=1
 extern char irc_nick[IRC_NICK_SIZE];
+// Mention matcher over irc_nick + highlight_words. Write irc_nick through
+// set_irc_nick() (or call hl_compile() after editing it) so hl_tab follows.
+extern char highlight_words[HIGHLIGHT_SIZE];
+extern uint8_t hl_tab[32];
+extern uint8_t hl_min;
+void hl_compile(void);
+void set_irc_nick(const char *nick) __z88dk_fastcall;
+extern uint8_t hl_match(const char *txt) __z88dk_fastcall;
 extern uint8_t irc_is_away;
 extern uint8_t ping_latency;
 extern char away_message[32];
@@ -297,6 +342,7 @@ extern uint8_t nav_hist_ptr;
 
 // Ignore list
 extern char ignore_list[][16];
+extern uint8_t ignore_hash[MAX_IGNORES];   // irc_hash per ignore_list entry
 extern uint8_t ignore_count;
 
 // Theme attributes array — indices match Theme struct fields banner..border
@@ -385,6 +431,8 @@ extern uint8_t search_saw_server_notice; // Flag: server NOTICE during search (r
 extern uint8_t post_cancel_quiet;        // Countdown post-cancel to suppress h_default_cmd
 extern char search_pattern[SEARCH_PATTERN_SIZE];
 extern uint16_t search_index;
+extern uint16_t search_min_users;    // /search #pat >N, /list >N (0 = off)
+extern uint8_t elist_caps;
 
 // Search functions
 void cancel_search_state(void);
@@ -398,6 +446,13 @@ extern uint8_t last_ts_minute;
 extern uint8_t autojoin;
 extern uint8_t autojoin_defer_flags;
 extern uint8_t autojoin_ident_grace;
+extern uint8_t cap_nin;
+// Channel the one silent LIST #chan in flight (JOIN-time, count sync) asked
+// for, "" when none. Its 322 is matched by this name; 321/323 belong to it
+// until its 323 or list_auto_timer runs out (error numeric, flushed reply).
+extern char list_auto_chan[22];
+extern uint8_t list_auto_timer;
+extern uint8_t list_auto_wait;  // CH_FLAG_LISTING windows await list_auto_retry()
 extern char autojoin_channels[SEARCH_PATTERN_SIZE];
 
 // IRC parsing
@@ -413,9 +468,123 @@ extern char temp_input[LINE_BUFFER_SIZE];
 
 // RX line buffer
 extern char rx_line[RX_LINE_SIZE];
+extern char *rx_ptr;         // line from try_read_line_zc()
 extern uint16_t rx_pos;
 extern uint16_t rx_last_len;
 extern uint8_t rx_overflow;  // Flag: overflow detected (0 or 1)
+
+// RX loss counters, 16-bit and wrapping. Shown by !status, zeroed by
+// "!status reset". ASM uses the RXS_* offsets in 00_preamble.asm.
+typedef struct {
+    uint16_t peak;      // highest ring occupancy seen at drain commit
+    uint16_t full;      // rb_push/uart_drain_to_buffer stops on a full ring
+    uint16_t lost;      // lines discarded through the rx_overflow path
+    uint16_t pressure;  // buffer_pressure 0->1 transitions
+    uint16_t bursts;    // "[n lines lost]" markers printed
+} RxStats;
+extern RxStats rx_stats;
+extern uint16_t rx_burst_lost;  // lines lost in the current burst, not yet reported
+extern uint8_t scroll_count;    // scroll_main_zone() calls, wraps; read as a delta
+extern uint16_t loop_cost;      // parse cost of this loop iteration, RX_COST_* units
+
+// Estimated main-loop iteration lengths in 50 Hz frames. Shown by !status,
+// zeroed by "!status reset". The mainline runs with DI, so FRAMES misses
+// most of an iteration: the length is the larger of the FRAMES delta and
+// 1 + the RX_COST_* estimate (scrolls plus loop_cost). Status redraws,
+// overlay loads and input handling cost nothing in that estimate.
+typedef struct {
+    uint16_t hist[5];     // 1, 2, 3-4, 5-8, >8 frames
+    uint16_t worst;       // longest iteration estimated, in frames
+} FrameEst;
+extern FrameEst frame_est;
+
+#ifdef ST_STACKPROBE
+// Stack high-water mark (make stackprobe). main() paints the 512B CRT stack
+// and stack_probe() (ASM) finds the deepest byte that lost the paint.
+// Tags: last_cmd_id for IRC lines, two lowercase letters for a typed
+// /command or !command, 0 for anything else in the main loop.
+typedef struct {
+    uint16_t peak;        // deepest use seen, bytes below REGISTER_SP
+    uint16_t peak_tag;    // what was running when it was reached
+} StackStats;
+extern StackStats stack_stats;
+extern void stack_paint(void);
+extern void stack_probe(uint16_t tag) __z88dk_fastcall;
+#endif
+
+#ifdef ST_IM2
+// IM2 frame drain (make im2); see IM2 FRAME DRAIN in 80_ui_runtime.asm.
+// process_irc_data() opens a window per line and closes it after its loop;
+// overlay_exec() closes it because ring_buffer stops being the RX ring.
+extern void im2_setup(void);
+extern void im2_window_open(void);
+extern void im2_window_close(void);
+#endif
+
+#ifdef ST_BANK128
+// 16 KB RX staging ring in 128K bank 6 (make bank128); see BANK RING in
+// 20_rx_ring_uart.asm. bank_pump() empties ring_buffer into it and
+// try_read_line_nodrain() reads lines from it. bank_ok = 0 on 48K machines
+// or with paging locked; ring_buffer alone is used then.
+#define BANK_RING_SIZE 16384
+#define BANK_RING_MASK (BANK_RING_SIZE - 1)
+extern uint8_t bank_ok;
+extern uint16_t bank_head;
+extern uint16_t bank_tail;
+extern void bank_setup(void);
+extern void bank_pump(void);
+extern uint16_t bank_discard(void);  // empties the bank ring; LFs dropped
+#endif
+
+#ifdef ST_PASSIVE
+// Passive receive link (make passive); see PASSIVE RECEIVE in spectalk.c.
+// irc_passive asks for AT+CIPRECVMODE=1 at connect time.
+// esp_passive stays 0 (transparent link) when the firmware refuses it.
+#ifdef ST_IM2
+#error "make passive pulls RX data in the main loop; do not combine with ST_IM2"
+#endif
+extern uint8_t esp_passive;
+extern uint8_t esp_tx_wrap;     // ay_uart_send() hands bytes to esp_tx_byte()
+extern void esp_passive_start(void);
+extern uint8_t esp_passive_stop(void);
+extern void esp_pull(void);
+extern void esp_tx_byte(uint8_t c) __z88dk_fastcall;
+extern void esp_tx_flush(void);         // queued bytes out as one CIPSEND
+extern void uart_drain_raw(void);       // drain body without the esp_pull() gate
+extern int16_t uart_read_byte(void);    // -1 when no byte is waiting
+extern uint8_t rb_push(uint8_t b) __z88dk_fastcall;
+#endif
+
+#ifdef ST_TRACE
+// Event trace ring (make trace). trace_ev() (ASM) appends {id, FRAMES low,
+// arg}; !trace writes the ring to SD for tools/zxtrace.py.
+#define TRACE_RECORDS   64      // power of 2; TRACE_MASK in 10_core_helpers
+#define TR_IRC_IN       1       // process_irc_data entry, arg = ring backlog
+#define TR_IRC_OUT      2       // process_irc_data exit, arg = ring backlog
+#define TR_DISPATCH     3       // parse_irc_message dispatch, arg = cmd_id
+#define TR_OVERLAY      4       // overlay_exec, arg = entry_id << 8 | ovl_id
+#define TR_SCROLL       5       // scroll_main_zone, arg = rb_head
+#define TR_DISCONNECT   6       // force_disconnect, arg = connection_state
+#define TR_PING         7       // keepalive/lag PING sent, arg = silence frames
+#define TR_PONG         8       // PONG received, arg = frames since PING
+#define TR_DUMP         9       // !trace, arg = records written (mod 256)
+typedef struct {
+    uint8_t head;                         // records written, mod 256
+    uint8_t rec[TRACE_RECORDS * 4];       // id, FRAMES low, arg lo, arg hi
+} TraceRing;
+extern TraceRing trace_ring;
+extern void trace_ev(uint16_t arg, uint8_t id) __z88dk_callee;
+#endif
+
+#ifdef ST_RECORD
+// !record raw RX tee to SD (make record); see SESSION RECORDER in user_cmds.c.
+// ASM reads rec_handle/rec_tail/rec_lost/rec_marks for the ring floor.
+extern uint8_t rec_handle;
+extern uint16_t rec_tail;
+extern uint16_t rec_lost;
+extern uint8_t rec_marks;
+extern void rec_flush(void);
+#endif
 extern void reset_rx_state(void);  // Zeros rb_head/rb_tail/rx_pos/rx_overflow
 
 // UART drain
@@ -471,6 +640,7 @@ extern const char S_AT_CIPMUX0[];
 extern const char S_AT_CIPSERVER0[];
 extern const char S_PROMPT[];
 extern const char S_CAP_END[];
+extern const char S_CAP_NIN[];
 extern const char S_GLOBAL[];
 extern const char S_TOPIC_PFX[];
 extern const char S_CONN_REFUSED[];
@@ -576,6 +746,7 @@ int8_t find_channel(const char *name) __z88dk_fastcall;
 int8_t find_query(const char *nick) __z88dk_fastcall;
 int8_t find_empty_channel_slot(void);
 int8_t add_channel(const char *name) __z88dk_fastcall;
+void set_channel_name(ChannelInfo *ch, const char *name) __z88dk_callee;
 uint8_t snapshot_autojoin_channels(void);
 int8_t add_query(const char *nick) __z88dk_fastcall;
 void remove_channel(uint8_t idx) __z88dk_fastcall;
@@ -605,6 +776,7 @@ extern uint8_t irc_params_dirty;
 void uart_drain_to_buffer(void);
 void wait_drain(uint8_t frames) __z88dk_fastcall;
 void flush_all_rx_buffers(void);
+uint16_t rx_backlog(void);  // unread RX bytes on the 2 KB pressure scale
 void uart_send_crlf(void) __z88dk_fastcall;
 void uart_send_line(const char *s) __z88dk_fastcall;
 
@@ -626,6 +798,7 @@ void irc_check_friends_online(void);
 void nick_try_alternate(void);
 
 extern char friend_nicks[MAX_FRIENDS][IRC_NICK_SIZE];
+extern uint8_t friend_hash[MAX_FRIENDS];   // irc_hash per slot, 0 = empty
 extern uint8_t friends_ison_sent;
 extern uint8_t friend_count;
 
@@ -634,6 +807,8 @@ extern uint8_t friend_count;
 // =============================================================================
 void parse_irc_message(char *line) __z88dk_fastcall;
 void process_irc_data(void);
+void list_auto_send(uint8_t idx) __z88dk_fastcall;
+void list_auto_retry(void);
 
 // =============================================================================
 // FUNCTION DECLARATIONS - USER COMMANDS (user_cmds.c)
@@ -57,6 +57,7 @@ static uint8_t bm_apply_line(const char *p, uint8_t mode)
     p = bm_next_field(p, irc_port, IRC_PORT_SIZE);
     p = bm_next_field(p, irc_pass, IRC_PASS_SIZE);
     p = bm_next_field(p, autojoin_channels, SEARCH_PATTERN_SIZE);
+    irc_passive = (*p == '1');      // optional fifth field: passive link
     st_copy_n(search_pattern, autojoin_channels, SEARCH_PATTERN_SIZE);
 
     if (!irc_server[0]) {
@@ -115,6 +116,7 @@ void bookmarks_save_ovl(void)
     p = bm_put_field(p, irc_port);
     p = bm_put_field(p, irc_pass);
     p = bm_put_field(p, search_pattern);
+    if (irc_passive) p = bm_put_field(p, "1");
     p[-1] = '\n';
 
     expected = (uint16_t)(p - (char *)overlay_slot);
@@ -220,6 +220,7 @@ void friend_cmd_ovl(void)
     uint8_t i;
     char *fn;
     char *free_fn = 0;
+    uint8_t free_i = 0;
 
     if (!*args) {
         set_attr_sys();
@@ -235,6 +236,7 @@ void friend_cmd_ovl(void)
         if (*fn) {
             if (st_stricmp(fn, args) == 0) {
                 *fn = '\0';
+                friend_hash[MAX_FRIENDS - i] = 0;
                 friend_count--;
                 set_attr_sys();
                 main_puts("- ");
@@ -244,11 +246,13 @@ void friend_cmd_ovl(void)
             }
         } else if (!free_fn) {
             free_fn = fn;
+            free_i = MAX_FRIENDS - i;
         }
     }
 
     if (free_fn) {
         st_copy_n(free_fn, args, IRC_NICK_SIZE);
+        friend_hash[free_i] = irc_hash(free_fn);
         friend_count++;
         set_attr_sys();
         main_puts("+ ");
@@ -53,6 +53,7 @@ extern char *skip_spaces(char *p) __z88dk_fastcall;
 extern char *split_at_space(char *p) __z88dk_fastcall;
 extern uint8_t st_strlen(const char *s) __z88dk_fastcall;
 extern int st_stricmp(const char *a, const char *b) __z88dk_callee;
+extern uint8_t irc_hash(const char *s) __z88dk_fastcall;
 extern void st_copy_n(char *dst, const char *src, uint8_t max_len);
 extern uint16_t str_to_u16(const char *s) __z88dk_fastcall;
 extern char *u16_to_dec(char *dst, uint16_t v) __z88dk_callee;
@@ -120,6 +121,7 @@ extern const char SB_SMART[];
 extern char     irc_nick[];
 extern char     irc_server[];
 extern char     irc_port[];
+extern uint8_t  irc_passive;
 extern char     irc_pass[];
 extern char     nickserv_pass[];
 extern char     nickserv_nick[];
@@ -157,7 +159,9 @@ extern uint8_t  last_frames_lo;
 extern uint16_t tick_accum;
 extern char     search_pattern[];
 extern char     autojoin_channels[];
+extern char     highlight_words[];    /* highlight= words, ',' separated */
 extern char     friend_nicks[][18];   /* MAX_FRIENDS(5) x IRC_NICK_SIZE(18) */
+extern uint8_t  friend_hash[];        /* irc_hash per friend_nicks slot, 0 = empty */
 extern uint8_t  friend_count;
 extern char     ignore_list[][16];
 extern uint8_t  ignore_count;
@@ -187,6 +191,7 @@ extern const char K_CFG_ALT[];
 extern const char K_TZ[];
 extern const char K_NOTIF[];
 extern const char K_COUNTSYNC[];
+extern const char K_PASSIVE[];
 extern const char S_ANYKEY[];
 
 /* ===== Theme attribute indices (must match spectalk.h) ===== */
@@ -17,6 +17,12 @@ extern uint8_t channels[];
 extern char    network_name[];
 extern uint8_t ping_latency;
 extern uint16_t uptime_minutes;
+extern uint16_t rx_stats[5];    /* RxStats: peak, full, lost, pressure, bursts */
+extern uint16_t frame_est[6];   /* FrameEst: hist[5], worst */
+#ifdef ST_STACKPROBE
+extern uint16_t stack_stats[2]; /* StackStats: peak, peak_tag */
+extern void stack_paint(void);
+#endif
 extern void reset_rx_state(void);
 #define MAX_CHANNELS    10
 #define CH_SIZE         32
@@ -35,6 +41,13 @@ static const char ss_state[] = "State:";
 static const char ss_lag[]   = "Latency:";
 static const char ss_up[]    = "Uptime:";
 static const char ss_chans[] = "Channels:";
+static const char ss_rx[]    = "RX ring:";
+static const char ss_rxk[]   = "peak \0full \0lost \0press \0burst ";
+static const char ss_fr[]    = "Frm est:";
+static const char ss_frk[]   = "1:\0" "2:\0" "3-4:\0" "5-8:\0" ">8:\0" "max ";
+#ifdef ST_STACKPROBE
+static const char ss_stk[]   = "Stack:";
+#endif
 
 static uint8_t status_row(uint8_t r, const char *lbl, const char *val) __z88dk_callee
 {
@@ -43,9 +56,37 @@ static uint8_t status_row(uint8_t r, const char *lbl, const char *val) __z88dk_c
     return (uint8_t)(r + 1);
 }
 
+/* Append n "key value " pairs; keys are NUL-separated and carry their own
+ * separator. Returns the end (after the trailing space). */
+static char *stat_pairs(char *p, const char *k, const uint16_t *v, uint8_t n) __z88dk_callee
+{
+    do {
+        while (*k) *p++ = *k++;
+        k++;
+        p = u16_to_dec(p, *v++);
+        *p++ = ' ';
+    } while (--n);
+    return p;
+}
+
 void status_render_ovl(void)
 {
-    uint8_t r = overlay_header("Status");
+    uint8_t r;
+
+    /* "!status reset": sys_status() copied the argument to overlay_slot */
+    if (st_stricmp((const char *)overlay_slot, "reset") == 0) {
+        uint16_t *z = rx_stats;
+        uint8_t i;
+        for (i = 5; i != 0; i--) *z++ = 0;
+        z = frame_est;
+        for (i = 6; i != 0; i--) *z++ = 0;
+#ifdef ST_STACKPROBE
+        stack_stats[0] = 0;
+        stack_paint();
+#endif
+    }
+
+    r = overlay_header("Status");
     uint8_t a_nick = theme_attrs[TATTR_MSG_NICK];
     uint8_t a_chan  = theme_attrs[TATTR_MSG_CHAN];
 
@@ -89,6 +130,39 @@ void status_render_ovl(void)
       r = status_row(r, ss_up, ubuf);
     }
 
+    /* RX ring loss counters since boot or the last !status reset */
+    { char rbuf[64];
+      char *p = stat_pairs(rbuf, ss_rxk, rx_stats, 5);
+      p[-1] = 0;
+      r = status_row(r, ss_rx, rbuf);
+
+      /* Estimated main-loop iteration lengths, then the longest */
+      p = stat_pairs(rbuf, ss_frk, frame_est, 6);
+      p[-1] = 0;
+      r = status_row(r, ss_fr, rbuf);
+
+#ifdef ST_STACKPROBE
+      /* Deepest CRT stack use and what was running: IRC numeric or
+       * command id, /command (lowercase tag) or the main loop (0) */
+      { uint16_t tag = stack_stats[1];
+        p = u16_to_dec(rbuf, stack_stats[0]);
+        *p++ = '/'; *p++ = '5'; *p++ = '1'; *p++ = '2';
+        *p++ = ' '; *p++ = 'i'; *p++ = 'n'; *p++ = ' ';
+        if (!tag) {
+            *p++ = 'l'; *p++ = 'o'; *p++ = 'o'; *p++ = 'p';
+        } else if (tag < 1000) {
+            p = u16_to_dec(p, tag);
+        } else {
+            if (tag & 0x2000) *p++ = '/';
+            *p++ = (char)(tag >> 8);
+            *p++ = (char)tag;
+        }
+        *p = 0;
+      }
+      r = status_row(r, ss_stk, rbuf);
+#endif
+    }
+
     r++; /* blank line before channels */
     print_str64(r++, 2, ss_chans, a_nick);
     { uint8_t rl = r, rr = r;  /* two-column row counters */
@@ -132,6 +206,7 @@ extern void ui_err(const char *s) __z88dk_fastcall;
 static const char CK_HDR[]  = "; SpecTalkZX config\r\n";
 static const char CK_NKS[]  = "nickserv=";
 static const char CK_TZLAST[] = "tzlast=";
+static const char CK_HILITE[] = "highlight=";
 #define CFG_END       ((char *)overlay_slot + OVERLAY_SLOT_SIZE)
 #define CFG_TOO_LARGE (CFG_END + 1)
 extern char *cfg_put_autojoin(char *p) __z88dk_fastcall;
@@ -170,7 +245,8 @@ void save_config_ovl(void)
         { K_AUTOCONN, &autoconnect },
         { K_AUTOJOIN, &autojoin },
         { K_NOTIF, &notif_enabled },
-        { K_COUNTSYNC, &count_sync_enabled }
+        { K_COUNTSYNC, &count_sync_enabled },
+        { K_PASSIVE, &irc_passive }
     };
 
     p = cfg_put(p, CK_HDR);
@@ -181,11 +257,12 @@ void save_config_ovl(void)
     if (irc_pass[0])      p = cfg_kv(p, K_PASS, irc_pass);
     if (nickserv_pass[0]) p = cfg_kv(p, K_NKPASS, nickserv_pass);
     if (nickserv_nick[0]) p = cfg_kv(p, CK_NKS, nickserv_nick);
+    if (highlight_words[0]) p = cfg_kv(p, CK_HILITE, highlight_words);
 
     /* W15: cfg_kv small-int trick — values 0-9 passed as (const char*)(uint16_t)N.
      * cfg_kv ASM detects D==0 && E<10 and writes single ASCII digit.
      * CONSTRAINT: all values below MUST be 0-9. */
-    for (i = 0; i < 11; i++)
+    for (i = 0; i < 12; i++)
         p = cfg_kv(p, flags[i].k, (const char *)(uint16_t)*(flags[i].v));
 
     if (autoaway_minutes) {
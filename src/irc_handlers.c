@@ -44,10 +44,13 @@ static void h_numeric_default(void);
 static void session_autoidentify_done(void);
 extern uint8_t names_render_grid(char *p) __z88dk_fastcall;
 extern uint8_t names_count_line(char *p) __z88dk_fastcall;
-extern uint8_t friend_initial_match(char c) __z88dk_fastcall;
+extern uint8_t friend_hash_hit(uint8_t h) __z88dk_fastcall;
 // INTERNAL HELPERS
 // =============================================================================
 
+// FRAMES low byte. Only ticks in frame waits (and make im2 drain windows).
+#define RX_FRAMES (*(volatile uint8_t *)23672)
+
 // Notification string builder: global pointer + fastcall = ~6B per call
 extern char *nb_p;
 #define NB_END() (*nb_p = 0)
@@ -182,6 +185,212 @@ inc_bad:
     __endasm;
 }
 
+// Drop table run by process_irc_data() on the raw line, before
+// parse_irc_message() tokenizes or sanitizes it (zero-copy lines are still in
+// ring_buffer). Only lines whose handler would return without side effects:
+//   show_names_list   all but 353/366/PING/PONG (same gate as the dispatcher)
+//   search flush      321/322/323/352/315 while a LIST/WHO is being drained
+//   ignore list       PRIVMSG, and NOTICE unless auto-identify may need it
+// JOIN/PART/QUIT always pass: their handlers keep counts and queries in step
+// even with traffic hidden. Returns 1 to drop; the line is left intact.
+static uint8_t rx_line_denied(char *line) __z88dk_fastcall ST_NAKED
+{
+    (void)line;
+    __asm
+    ld a,(hl)
+    cp 33
+    jp c,rld_keep_now       ; leading noise: parse_irc_message decides
+    cp 127
+    jp nc,rld_keep_now
+    cp '>'
+    jp z,rld_keep_now
+    ld de,0                 ; DE = nick (0: no prefix or server prefix)
+    cp '@'
+    call z,rld_word         ; IRCv3 tags
+    ld a,(hl)
+    cp ':'
+    jr nz,rld_cmd
+    inc hl
+    ld d,h
+    ld e,l
+rld_nick:
+    ld a,(hl)
+    cp 33
+    jr c,rld_nick_end
+    jr z,rld_nick_end       ; '!'
+    cp '.'
+    jr nz,rld_nick_next
+    ld de,0                 ; server names never match the ignore list
+rld_nick_next:
+    inc hl
+    jr rld_nick
+rld_nick_end:
+    ld b,h
+    ld c,l                  ; BC = nick terminator
+    call rld_word
+rld_cmd:
+    push de
+    push bc
+    ld d,(hl)               ; D = cmd[0]
+    inc hl
+    ld e,(hl)               ; E = cmd[1]
+    inc hl
+    ld c,(hl)               ; C = cmd[2]
+    ld b,0
+    ld a,e
+    or a
+    jr z,rld_keep
+    ld a,c
+    or a
+    jr z,rld_names
+    inc hl
+    ld a,(hl)
+    cp 33
+    jr nc,rld_names
+    inc b                   ; B = 1: three-character command
+rld_names:
+    ld a,(_show_names_list)
+    or a
+    jr z,rld_search
+    ld a,d
+    and 0xDF
+    cp 'P'
+    jr nz,rld_names_num
+    ld a,e
+    and 0xDF
+    cp 'I'
+    jr z,rld_keep
+    cp 'O'
+    jr z,rld_keep
+    jr rld_deny
+rld_names_num:
+    dec b
+    jr nz,rld_deny
+    ld a,d
+    cp '3'
+    jr nz,rld_deny
+    ld a,e
+    cp '5'
+    ld a,c
+    jr z,rld_names_353
+    cp '6'
+    jr nz,rld_deny
+    ld a,e
+    cp '6'
+    jr z,rld_keep
+    jr rld_deny
+rld_names_353:
+    cp '3'
+    jr z,rld_keep
+    jr rld_deny
+rld_deny:
+    pop bc
+    pop de
+    ld l,1
+    ret
+rld_keep:
+    pop bc
+    pop de
+rld_keep_now:
+    ld l,0
+    ret
+
+rld_search:
+    ld a,(_search_flush_state)
+    dec a
+    jr nz,rld_ignore
+    ld a,(_pagination_active)
+    or a
+    jr z,rld_ignore
+    ld a,(_search_mode)
+    or a
+    jr z,rld_ignore
+    ld a,b
+    or a
+    jr z,rld_ignore
+    ld a,d
+    cp '3'
+    jr nz,rld_ignore
+    ld a,e
+    cp '2'
+    jr z,rld_search_32x
+    ld a,c
+    cp '5'
+    jr z,rld_search_315
+    cp '2'
+    jr nz,rld_ignore
+    ld a,e
+    cp '5'
+    jr z,rld_deny           ; 352
+    jr rld_ignore
+rld_search_315:
+    ld a,e
+    cp '1'
+    jr z,rld_deny
+    jr rld_ignore
+rld_search_32x:
+    ld a,c                  ; 321/322/323
+    sub '1'
+    cp 3
+    jr c,rld_deny
+rld_ignore:
+    ld a,(_ignore_count)
+    or a
+    jr z,rld_keep
+    ld a,e
+    and 0xDF
+    ld e,a
+    ld a,d
+    and 0xDF
+    cp 'P'
+    jr nz,rld_ignore_notice
+    ld a,e
+    cp 'R'
+    jr rld_ignore_cmd
+rld_ignore_notice:
+    cp 'N'
+    jr nz,rld_keep
+    ld a,(_nickserv_pass)
+    or a
+    jr nz,rld_keep          ; auto-identify reads NOTICE before the ignore test
+    ld a,e
+    cp 'O'
+rld_ignore_cmd:
+    jr nz,rld_keep
+    pop bc
+    pop hl                  ; HL = nick, BC = its terminator
+    ld a,h
+    or l
+    jr z,rld_keep_now
+    ld a,(bc)
+    push bc
+    push af
+    xor a
+    ld (bc),a
+    call _is_ignored
+    pop af
+    pop bc
+    ld (bc),a               ; restore '!' or the separator
+    ret
+rld_word:                   ; skip one word and the separators after it
+    ld a,(hl)
+    cp 33
+    jr c,rld_sep
+    inc hl
+    jr rld_word
+rld_sep:
+    or a
+    ret z
+    inc hl
+    ld a,(hl)
+    cp 33
+    jr c,rld_sep
+    cp 127
+    jr nc,rld_sep
+    ret
+    __endasm;
+}
+
 // Notify with prefix+value: replaces nb_init+nb+NB_END+notify at each call site
 static void notify2(const char *a, const char *b, uint8_t attr) __z88dk_callee
 {
@@ -247,7 +456,7 @@ static void h_nick(void)
     if (*new_nick == ':') new_nick++;
 
     if (st_stricmp(pkt_usr, irc_nick) == 0) {
-        st_copy_n(irc_nick, new_nick, sizeof(irc_nick));
+        set_irc_nick(new_nick);
         draw_status_bar();
         notify2("You are now ", irc_nick, ATTR_MSG_SYS);
         if (autojoin_defer_flags & AUTOJOIN_IDENT_SENT) session_autoidentify_done();
@@ -259,7 +468,7 @@ static void h_nick(void)
     for (i = 1, ch = &channels[1]; i < MAX_CHANNELS; i++, ch++) {
         if ((ch->flags & (CH_FLAG_ACTIVE | CH_FLAG_QUERY)) == (CH_FLAG_ACTIVE | CH_FLAG_QUERY)) {
             if (st_stricmp(ch->name, pkt_usr) == 0) {
-                st_copy_n(ch->name, new_nick, sizeof(channels[0].name));
+                set_channel_name(ch, new_nick);
 
                 if (current_channel_idx == i) {
                     main_print_time_prefix();
@@ -276,12 +485,40 @@ static void h_nick(void)
     }
 }
 
+// CAP subcommand: 'L' (LS), 'A' (ACK), 'N' (NAK), 0 otherwise
+static char cap_sub(const char *p) __z88dk_fastcall
+{
+    if (p[0] == 'L' && p[1] == 'S' && !p[2]) return 'L';
+    if (((p[0] == 'A' && p[1] == 'C') || (p[0] == 'N' && p[1] == 'A')) && p[2] == 'K' && !p[3])
+        return p[0];
+    return 0;
+}
+
+// CAP negotiation; cmd_connect() routes registration-time CAP lines here.
+// LS notes whether draft/no-implicit-names is offered and, on the last line
+// (no "*" continuation under CAP LS 302), REQs it or ENDs. ACK/NAK END.
 static void h_cap(void)
 {
-    const char *p = pkt_par;
-    if (!(p[0] == 'L' && (p[1] == 'S' || p[1] == 0))) {
-        p = irc_param(1);
-        if (!(p[0] == 'L' && (p[1] == 'S' || p[1] == 0))) return;
+    uint8_t i = 0;
+    const char *caps;
+    char sub = cap_sub(pkt_par);
+    if (!sub) sub = cap_sub(irc_param(i = 1));
+    caps = *pkt_txt ? pkt_txt : irc_param(i + 1);
+
+    if (sub == 'L') {
+        if (st_stristr(caps, S_CAP_NIN)) cap_nin = CAP_NIN_OFFERED;
+        if (irc_param(i + 1)[0] == '*') return;
+        if (cap_nin == CAP_NIN_OFFERED) {
+            uart_send_string("CAP REQ :");
+            uart_send_line(S_CAP_NIN);
+            return;
+        }
+    } else if (sub == 'A') {
+        if (st_stristr(caps, S_CAP_NIN)) cap_nin = CAP_NIN_ACTIVE;
+    } else if (sub == 'N') {
+        cap_nin = 0;
+    } else {
+        return;
     }
     uart_send_line(S_CAP_END);
 }
@@ -514,7 +751,7 @@ static void h_privmsg_notice(void)
         if (!is_server && count_sync_enabled) count_sync_idle_frames = 0;
 
         // Mención en canal NO activo: marcar flag y salir
-        if (!overlay_mode && (uint8_t)idx != current_channel_idx && irc_nick[0] && st_stristr(pkt_txt, irc_nick)) {
+        if (!overlay_mode && (uint8_t)idx != current_channel_idx && hl_match(pkt_txt)) {
             channels[(uint8_t)idx].flags |= CH_FLAG_MENTION;
             status_bar_dirty = 1;
             mention_beep();
@@ -622,7 +859,7 @@ static void h_privmsg_notice(void)
 
         // Mention: BRIGHT highlight + beep
         set_attr_chan();
-        if (!overlay_mode && irc_nick[0] && st_stristr(pkt_txt, irc_nick)) {
+        if (!overlay_mode && hl_match(pkt_txt)) {
             current_attr |= 0x40;
             mention_beep();
         }
@@ -671,6 +908,104 @@ static void h_privmsg_notice(void)
     }
 }
 
+// Traffic coalescing: while buffer_pressure is set, JOIN/PART/QUIT lines for
+// the active window are only counted, and rx_loss_tick() prints one summary
+// ("+14 joined, -9 left #chan: nickA, nickB, ...") once the burst settles or
+// TC_FLUSH_FRAMES after the first one. User counts and friend notices are
+// handled as usual by the callers.
+#define TC_NICKS_SIZE   48
+#define TC_MORE_SIZE    6       // ", ..." and its NUL, always left free
+#define TC_FLUSH_FRAMES 100     // 2s
+static uint8_t tc_idx;          // window the pending counts belong to
+static uint8_t tc_join;
+static uint8_t tc_left;
+static uint8_t tc_start;        // FRAMES low byte of the first pending event
+static uint8_t tc_nlen;         // TC_NICKS_SIZE once ", ..." was appended
+static char tc_nicks[TC_NICKS_SIZE];
+
+static void traffic_flush(void)
+{
+    char buf[6];
+
+    if (channels[tc_idx].flags & CH_FLAG_ACTIVE) {
+        main_print_time_prefix();
+        set_attr_join();
+        if (tc_join) {
+            u16_to_dec(buf, tc_join);
+            main_putc('+'); main_puts2(buf, " joined");
+            if (tc_left) main_puts(", ");
+        }
+        if (tc_left) {
+            u16_to_dec(buf, tc_left);
+            main_putc('-'); main_puts2(buf, " left");
+        }
+        main_putc(' '); main_puts2(channels[tc_idx].name, S_COLON_SP);
+        main_print(tc_nicks);
+    }
+    tc_join = tc_left = 0;
+}
+
+// Returns 1 when the event was absorbed; 0 means print it as usual.
+static uint8_t traffic_coalesce(uint8_t join) __z88dk_fastcall
+{
+    uint8_t n;
+
+    if (!buffer_pressure || overlay_mode) return 0;
+    if ((tc_join | tc_left) && tc_idx != current_channel_idx) traffic_flush();
+    if (!(tc_join | tc_left)) {
+        tc_idx = current_channel_idx;
+        tc_start = RX_FRAMES;
+        tc_nlen = 0;
+    }
+    if (join) { if (tc_join != 255) tc_join++; }
+    else if (tc_left != 255) tc_left++;
+
+    // Every store is bounded by what is left of tc_nicks. An appended nick
+    // keeps tc_nlen + TC_MORE_SIZE <= sizeof(tc_nicks), so ", ..." always fits.
+    if (tc_nlen < TC_NICKS_SIZE) {
+        n = st_strlen(pkt_usr);
+        if ((uint16_t)tc_nlen + 2 + n + TC_MORE_SIZE <= sizeof(tc_nicks)) {
+            if (tc_nlen) { tc_nicks[tc_nlen++] = ','; tc_nicks[tc_nlen++] = ' '; }
+            st_copy_n(tc_nicks + tc_nlen, pkt_usr, sizeof(tc_nicks) - tc_nlen);
+            tc_nlen += n;
+        } else {
+            st_copy_n(tc_nicks + tc_nlen, tc_nlen ? ", ..." : "...",
+                      sizeof(tc_nicks) - tc_nlen);
+            tc_nlen = TC_NICKS_SIZE;
+        }
+    }
+    return 1;
+}
+
+// One silent LIST at a time: its replies are told apart by the name it
+// asked for, never by counting what the server still owes us.
+void list_auto_send(uint8_t idx) __z88dk_fastcall
+{
+    st_copy_n(list_auto_chan, channels[idx].name, sizeof(list_auto_chan));
+    list_auto_timer = LIST_AUTO_TIMEOUT_FRAMES;
+    irc_send_cmd1("LIST", list_auto_chan);
+}
+
+// JOIN-time LISTs held back by a /list, /search, /names or another silent
+// LIST, or lost to a flush or an error reply, go out one by one once the
+// main area is free again. One retry per window.
+void list_auto_retry(void)
+{
+    uint8_t i;
+
+    if (pagination_active || list_auto_chan[0] ||
+        connection_state < STATE_IRC_READY) return;
+    list_auto_wait = 0;
+    for (i = 1; i < MAX_CHANNELS; i++) {
+        if (channels[i].flags & CH_FLAG_LISTING) {
+            channels[i].flags &= (uint8_t)~CH_FLAG_LISTING;
+            list_auto_send(i);
+            list_auto_wait = 1;  // the rest follow its 323
+            return;
+        }
+    }
+}
+
 static void h_join(void)
 {
     // Channel is first param; fallback to pkt_txt only if pkt_par is empty
@@ -694,14 +1029,22 @@ static void h_join(void)
 
         // GUARD: re-copy name to slot — workaround for observed corruption
         // when joining channels rapidly while NAMES flood is in progress
-        st_copy_n(channels[idx].name, chan, sizeof(channels[0].name));
+        set_channel_name(&channels[idx], chan);
 
         channels[idx].user_count = 0;
-        channels[idx].flags |= CH_FLAG_NAMING;
-        counting_new_users = 1;
-        st_copy_n(names_target_channel, chan, sizeof(names_target_channel));
-        names_pending = 1;
-        names_timeout_frames = 0;
+        if (cap_nin == CAP_NIN_ACTIVE) {
+            // No implicit NAMES: one 322 sets the count (h_numeric_322_352).
+            // A /list or /search owns LIST replies until it ends.
+            channels[idx].flags |= CH_FLAG_LISTING;
+            if (pagination_active || list_auto_chan[0]) list_auto_wait = 1;
+            else list_auto_send((uint8_t)idx);
+        } else {
+            channels[idx].flags |= CH_FLAG_NAMING;
+            counting_new_users = 1;
+            st_copy_n(names_target_channel, chan, sizeof(names_target_channel));
+            names_pending = 1;
+            names_timeout_frames = 0;
+        }
         draw_status_bar();
     } else {
         int8_t idx = find_channel(chan);
@@ -715,7 +1058,7 @@ static void h_join(void)
             }
 
             if ((uint8_t)idx == current_channel_idx) {
-                if (show_traffic) {
+                if (show_traffic && !traffic_coalesce(1)) {
                     main_print_time_prefix();
                     set_attr_join();
                     main_puts2(S_ARROW_OUT, pkt_usr);
@@ -761,7 +1104,7 @@ static void h_part(void)
             channel_dec_users(idx);
 
             if ((uint8_t)idx == current_channel_idx) {
-                if (show_traffic) print_departure(" left");
+                if (show_traffic && !traffic_coalesce(0)) print_departure(" left");
                 draw_status_bar();
             }
         }
@@ -774,7 +1117,7 @@ static void h_quit(void)
     if (!overlay_mode && is_tracked_friend(pkt_usr))
         notify2(pkt_usr, S_QUIT_SUFFIX, ATTR_MSG_NICK);
 
-    if (show_traffic && current_channel_idx) {
+    if (show_traffic && current_channel_idx && !traffic_coalesce(0)) {
         print_departure(S_QUIT_SUFFIX);
     }
 
@@ -1066,10 +1409,12 @@ static void h_numeric_353(void)
         char *p = pkt_txt;
         while (*p) {
             char *ns;
+            uint8_t h;
             while (*p == '@' || *p == '+' || *p == '~' || *p == '%' || *p == '&') p++;
             ns = p;
-            while (*p && *p != ' ') p++;
-            if (friend_initial_match(*ns) && p > ns) {
+            h = irc_hash(ns);   // also finds the end of the nick
+            p = irc_hash_end;
+            if (p > ns && friend_hash_hit(h)) {
                 char sv = *p; *p = 0;
                 if (is_tracked_friend(ns)) {
                     if (names_friend_pos > 0 && names_friend_pos < 46) {
@@ -1142,6 +1487,7 @@ static void h_numeric_366(void)
 
 static void h_numeric_321(void)
 {
+    if (list_auto_chan[0]) return;        // header of a silent LIST
     if (search_flush_state == 1) return;  // Todavía drenando
     search_header_rcvd = 1;
     // 321 es solo el header, no hacemos nada visible
@@ -1160,12 +1506,28 @@ is_network_param_key:
     __endasm;
 }
 
-static void h_end_of_list(void)
+static uint8_t is_elist_param(const char *p) __z88dk_fastcall ST_NAKED
 {
-    if (search_flush_state == 1) return;  // Todavía drenando
+    (void)p;
+    __asm
+    ld de,is_elist_param_key
+    ld b,6
+    jp fixed_token_bool_loop
+is_elist_param_key:
+    DEFM "ELIST="
+    __endasm;
+}
 
+static void h_end_of_list(void)
+{
     // OPT L6: Verificar segundo carácter ('2' para 323, '1' para 315)
     uint8_t c1 = pkt_cmd[1];
+    if (c1 == '2' && list_auto_chan[0]) {  // the silent LIST ended
+        list_auto_chan[0] = 0;
+        return;
+    }
+    if (search_flush_state == 1) return;  // Todavía drenando
+
     if (search_mode == SEARCH_CHAN && c1 != '2') return;  // 323
     if (search_mode == SEARCH_USER && c1 != '1') return;  // 315
     if (search_mode == SEARCH_NONE) return;
@@ -1209,7 +1571,7 @@ static void list_count_update(const char *chan, const char *users) __z88dk_calle
     ci = find_channel(chan);
     if (ci >= 0) {
         channels[ci].user_count = str_to_u16(users);
-        channels[ci].flags &= (uint8_t)~CH_FLAG_COUNT_DIRTY;
+        channels[ci].flags &= (uint8_t)~(CH_FLAG_COUNT_DIRTY | CH_FLAG_LISTING);
         if ((uint8_t)ci == current_channel_idx) draw_status_bar();
     }
 }
@@ -1219,11 +1581,12 @@ static void h_numeric_322_352(void)
     const char *chan, *users, *nick, *user, *host, *t;
     uint8_t len;
 
-    if (!pagination_active) {
-        if (!count_sync_enabled) return;
-        if (pkt_cmd[1] == '2') { // 322 from silent count LIST
-            list_count_update(irc_param(1), irc_param(2));
-        }
+    // 322 from silent count / JOIN-time LIST: joined-window count only, never
+    // a /list or /search row
+    if (!pagination_active || (pkt_cmd[1] == '2' && list_auto_chan[0] &&
+                               st_stricmp(irc_param(1), list_auto_chan) == 0)) {
+        if (!count_sync_enabled && cap_nin != CAP_NIN_ACTIVE) return;
+        if (pkt_cmd[1] == '2') list_count_update(irc_param(1), irc_param(2));
         return;
     }
 
@@ -1241,12 +1604,13 @@ static void h_numeric_322_352(void)
         users = irc_param(2);
 
         if (!chan[0]) return;
+        if (search_min_users && str_to_u16(users) <= search_min_users) return;
         if (search_pattern[0]) {
             if (IS_CHAN_PREFIX(search_pattern[0])) {
                 if (st_stricmp(chan, search_pattern) == 0)
                     list_count_update(chan, users);
-            } else if (!st_stristr(chan, search_pattern)) {
-                return;
+            } else if (!(elist_caps & ELIST_MASK) && !st_stristr(chan, search_pattern)) {
+                return;     // fallback: server did not apply the *mask*
             }
         }
 
@@ -1311,7 +1675,7 @@ static void h_numeric_1(void)
 
     const char *confirmed_nick = irc_param(0);
     if (confirmed_nick && *confirmed_nick) {
-        st_copy_n(irc_nick, confirmed_nick, sizeof(irc_nick));
+        set_irc_nick(confirmed_nick);
     }
     connection_state = STATE_IRC_READY;
     cursor_visible = 1;
@@ -1358,7 +1722,7 @@ static void h_numeric_303(void)
 
 static void h_numeric_5(void)
 {
-    // Busca "NETWORK=" en los params tokenizados (no en pkt_par raw)
+    // Busca "NETWORK=" y "ELIST=" en los params tokenizados (no en pkt_par raw)
     uint8_t pi;
     const char *net = NULL;
     irc_params_ensure();
@@ -1366,7 +1730,13 @@ static void h_numeric_5(void)
         const char *p = irc_param(pi);
         if (is_network_param(p)) {
             net = p + 8;
-            break;
+        } else if (is_elist_param(p)) {
+            elist_caps = ELIST_SEEN;
+            for (p += 6; *p; p++) {
+                char c = *p & 0xDF;
+                if (c == 'M') elist_caps |= ELIST_MASK;
+                else if (c == 'U') elist_caps |= ELIST_USERS;
+            }
         }
     }
     if (net) {
@@ -1538,6 +1908,9 @@ static void h_pong(void)
     }
     status_bar_dirty = 1;       // Redraw indicator
 
+#ifdef ST_TRACE
+    trace_ev(keepalive_timeout, TR_PONG);
+#endif
     // FIX ChatGPT audit: Borrar keepalive_ping_sent SOLO con PONG
     keepalive_ping_sent = 0;
     keepalive_timeout = 0;
@@ -1556,59 +1929,14 @@ typedef struct {
     void (*fn)(void);
 } CmdEntry;
 
+// Dispatch goes through the generated CMD_SLOT hash (include/cmd_hash.h);
+// only row 0 keeps a direct compare. The rows live in cmd_table.inc, the
+// generator's only input.
 static const CmdEntry CMD_TABLE[] = {
-    // PERF-01: Hot path primero (>80% del tráfico IRC)
-    { 0x5052, h_privmsg_notice }, // PR (PRIVMSG) - más frecuente
-    { 0x4E4F, h_privmsg_notice }, // NO (NOTICE)  - segundo más frecuente
-    { 0x5049, h_ping },           // PI (PING)    - keepalive frecuente
-
-    // Comandos Numéricos (0x0001 - 0x03E7)
-    { 353, h_numeric_353 },
-    { 366, h_numeric_366 },
-    { 322, h_numeric_322_352 },
-    { 352, h_numeric_322_352 },
-    { 323, h_end_of_list },
-    { 315, h_end_of_list },
-    { 1,   h_numeric_1 },
-    { 2,   h_ignore },
-    { 3,   h_ignore },
-    { 4,   h_ignore },
-    { 900, h_logged_in },        // RPL_LOGGEDIN (after NickServ IDENTIFY)
-    { 5,   h_numeric_5 },
-    { 303, h_numeric_303 },
-    { 305, h_numeric_305_306 },
-    { 306, h_numeric_305_306 },
-    { 321, h_numeric_321 },
-    { 324, h_numeric_324 },
-    { 332, h_numeric_332 },
-    { 376, h_motd_done },
-    { 401, h_numeric_401 },
-    { 433, h_numeric_433 },
-    { 422, h_motd_done },
-    { 451, h_numeric_451 },
-
-    { 403, h_join_error },
-    { 404, h_cannotsend },
-    { 405, h_join_error },
-    { 471, h_join_error },
-    { 473, h_join_error },
-    { 474, h_join_error },
-    { 477, h_join_error },
-
-    // Resto de comandos de texto (menos frecuentes)
-    { 0x504F, h_pong },           // PO (PONG)
-    { 0x5041, h_part },           // PA (PART)
-    { 0x4E49, h_nick },           // NI (NICK)
-    { 0x4A4F, h_join },           // JO (JOIN)
-    { 0x5155, h_quit },           // QU (QUIT)
-    { 0x4B49, h_kick_kill },      // KI (KICK/KILL)
-    { 0x4D4F, h_mode },           // MO (MODE)
-    { 0x4552, h_error },          // ER (ERROR)
-    { 0x4341, h_cap },            // CA (CAP)
-
+#include "cmd_table.inc"
 };
 
-#define CMD_TABLE_COUNT ((uint8_t)(sizeof(CMD_TABLE) / sizeof(CMD_TABLE[0])))
+#include "../include/cmd_hash.h"
 
 // =============================================================================
 // MAIN PARSING FUNCTIONS
@@ -1710,6 +2038,9 @@ void parse_irc_message(char *line) __z88dk_fastcall
         }
 
         last_cmd_id = cmd_id;  // OPT L7: guardar para handlers
+#ifdef ST_TRACE
+        trace_ev(cmd_id, TR_DISPATCH);
+#endif
 
         // Manual /names owns the main area. Keep the normal pagination/cancel
         // path, but do not let interleaved channel traffic render into it.
@@ -1719,12 +2050,17 @@ void parse_irc_message(char *line) __z88dk_fastcall
             return;
         }
 
+        // PRIVMSG (CMD_HOT_ID) is one compare; everything else is one probe
+        // whatever the table size. Unknown ids land on an empty slot or on a
+        // row whose id differs.
+        if (cmd_id == CMD_HOT_ID) { CMD_TABLE[0].fn(); return; }
         {
-            uint8_t n = CMD_TABLE_COUNT;
-            const CmdEntry *e = CMD_TABLE;
-            while (n--) {
+            uint8_t lo = (uint8_t)cmd_id;
+            uint8_t hi = (uint8_t)(cmd_id >> 8);
+            uint8_t i = CMD_SLOT[CMD_HASH(lo, hi)];
+            if (i) {
+                const CmdEntry *e = &CMD_TABLE[i - 1];
                 if (e->id == cmd_id) { e->fn(); return; }
-                e++;
             }
         }
 
@@ -1734,6 +2070,43 @@ void parse_irc_message(char *line) __z88dk_fastcall
 }
 
 
+// Loss bookkeeping after each RX pass. Flushes coalesced traffic once the ring
+// is under 25% or the summary is TC_FLUSH_FRAMES old. Prints one "[n lines
+// lost]" per burst once the ring has drained and the main area shows chat
+// again, and holds buffer_pressure from 75% fill or any loss until the ring
+// is under 25% and the loss has been reported. Fill is rx_backlog(), the
+// same measure as the MORE prompt, so the bank ring counts too.
+static void rx_loss_tick(void)
+{
+    uint16_t backlog = rx_backlog();
+    uint8_t p = buffer_pressure;
+    uint8_t main_free = !pagination_active && !overlay_mode &&
+                        !deferred_wrap_active && !show_names_list;
+
+    // Coalesced traffic first: it happened before any loss being reported
+    if ((tc_join | tc_left) && main_free &&
+        (backlog < BUFFER_RELIEF_THRESHOLD ||
+         (uint8_t)(RX_FRAMES - tc_start) >= TC_FLUSH_FRAMES))
+        traffic_flush();
+
+    if (rx_burst_lost && !backlog && !rx_pos && main_free) {
+        char buf[6];
+        u16_to_dec(buf, rx_burst_lost);
+        rx_burst_lost = 0;
+        rx_stats.bursts++;
+        nb_init("["); nb(buf); nb(" lines lost]"); NB_END();
+        ui_sys(temp_input);
+    }
+
+    if (backlog > BUFFER_PRESSURE_THRESHOLD || rx_burst_lost) p = 1;
+    else if (backlog < BUFFER_RELIEF_THRESHOLD) p = 0;
+    if (p != buffer_pressure) {
+        buffer_pressure = p;
+        if (p) rx_stats.pressure++;
+        draw_status_bar();
+    }
+}
+
 void process_irc_data(void)
 {
     uint16_t bytes_this_call = 0;
@@ -1754,15 +2127,27 @@ void process_irc_data(void)
         return;
     }
 
-    if (connection_state < STATE_TCP_CONNECTED) return;
+    if (connection_state < STATE_TCP_CONNECTED) {
+        tc_join = tc_left = 0;  // a summary never outlives its link
+        return;
+    }
 
     // Drain UART first, then measure real backlog
     uart_drain_to_buffer();
 
     backlog = (uint16_t)(rb_head - rb_tail) & RING_BUFFER_MASK;
+#ifdef ST_BANK128
+    backlog += (bank_head - bank_tail) & BANK_RING_MASK;
+#endif
 
     // Early-out when nothing to process
-    if (backlog == 0 && rx_pos == 0) return;
+    if (backlog == 0 && rx_pos == 0) {
+        if (rx_burst_lost | buffer_pressure | tc_join | tc_left) rx_loss_tick();
+        return;
+    }
+#ifdef ST_TRACE
+    trace_ev(backlog, TR_IRC_IN);
+#endif
 
     // Scale parse budget to real backlog
     if (backlog > 1024)      { max_lines = 32; }
@@ -1780,8 +2165,12 @@ void process_irc_data(void)
     uint8_t closed_detected = 0;
 
     while (1) {
-        if (!try_read_line_nodrain()) {
-            if (!rx_pos || !refills_left || deferred_wrap_active) break;
+#ifdef ST_IM2
+        im2_window_open();
+#endif
+        if (!try_read_line_zc()) {
+            // A partial line may sit in rx_line or, unscanned, in the ring
+            if ((!rx_pos && rb_head == rb_tail) || !refills_left || deferred_wrap_active) break;
 
             backlog = rb_head;
             uart_drain_to_buffer();
@@ -1802,9 +2191,9 @@ void process_irc_data(void)
         // FIX P0-1: Verificar longitud antes de acceder a índices fijos
         // "CLOSED" via 16-bit reads (Z80 little-endian: 'C','L' = 0x4C43)
         if (rx_last_len >= 6 &&
-            *(uint16_t*)(rx_line) == 0x4C43 &&
-            *(uint16_t*)(rx_line+2) == 0x534F &&
-            *(uint16_t*)(rx_line+4) == 0x4445) {
+            *(uint16_t*)(rx_ptr) == 0x4C43 &&
+            *(uint16_t*)(rx_ptr+2) == 0x534F &&
+            *(uint16_t*)(rx_ptr+4) == 0x4445) {
             // FIX P0-2: Solo marcar, no actuar dentro del bucle
             if (!closed_reported) {
                 closed_detected = 1;
@@ -1814,7 +2203,13 @@ void process_irc_data(void)
             server_silence_frames = 0;
             // FIX ChatGPT audit: NO borrar keepalive_ping_sent aquí
             // Solo debe borrarse al recibir PONG (se hace en handler de PONG)
-            parse_irc_message(rx_line);
+            // Dropped lines cost no parse slot, byte budget or drain pass.
+            if ((show_names_list || ignore_count || search_flush_state == 1) &&
+                rx_line_denied(rx_ptr)) continue;
+            parse_irc_message(rx_ptr);
+#ifdef ST_STACKPROBE
+            stack_probe(last_cmd_id);
+#endif
         }
 
         // Resident-only cooperative drain: keep UART/ESP from backing up while
@@ -1834,6 +2229,19 @@ void process_irc_data(void)
 
         if (lines_this_call >= max_lines) break;  // FIX P0-2: break en vez de return
     }
+    // A deferred wrap still prints from the held line; the next read frees it.
+    if (!deferred_wrap_active) rx_line_release();
+#ifdef ST_IM2
+    im2_window_close();
+#endif
+    rx_loss_tick();
+
+    // Parse cost feeds the main-loop frame estimate; its scrolls are
+    // counted there from scroll_count.
+    loop_cost += lines_this_call * RX_COST_LINE + (bytes_this_call >> RX_COST_BYTE_SHIFT);
+#ifdef ST_TRACE
+    trace_ev((uint16_t)(rb_head - rb_tail) & RING_BUFFER_MASK, TR_IRC_OUT);
+#endif
 
     // FIX P0-2: Actuar DESPUÉS de salir del bucle de consumo
     if (closed_detected) {
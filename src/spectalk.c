@@ -91,6 +91,7 @@ const char S_AT_CIPMUX0[] = "AT+CIPMUX=0";
 const char S_AT_CIPSERVER0[] = "AT+CIPSERVER=0";
 const char S_PROMPT[] = "> ";
 const char S_CAP_END[] = "CAP END";
+const char S_CAP_NIN[] = "draft/no-implicit-names";
 const char S_GLOBAL[] = "Global";
 const char S_TOPIC_PFX[] = "Topic: ";
 const char S_CONN_REFUSED[] = "Connection refused";
@@ -237,6 +238,8 @@ uint8_t search_mode;
 char    search_pattern[SEARCH_PATTERN_SIZE];  // Scratch: busquedas, snapshots de !config
 char    autojoin_channels[SEARCH_PATTERN_SIZE]; // channels= persistente cargado desde config
 uint16_t search_index;
+uint16_t search_min_users;               // 322 kept only if users > this (ELIST >N)
+uint8_t elist_caps;                      // ELIST_* from 005
 uint8_t channel_context_next_row;
 uint8_t channel_context_pending;
 static uint8_t channel_context_anchor_idx;
@@ -293,12 +296,31 @@ extern void put_char64_input_cached(uint8_t y, uint8_t col, char ch, uint8_t att
 // ring_buffer placed via defc in spectalk_asm.asm (outside BSS, fixed address)
 uint16_t rb_head;
 uint16_t rb_tail;
+#ifdef ST_BANK128
+uint8_t bank_ok;
+uint16_t bank_head;
+uint16_t bank_tail;
+#endif
 
 // Line parser state
 char rx_line[RX_LINE_SIZE];
+char *rx_ptr;
+// Zero-copy line held in ring_buffer: _rb_tail moves to rx_zc_next on release
+uint8_t rx_zc_held;
+uint16_t rx_zc_start;
+uint16_t rx_zc_next;
+// LF index: ring offsets of queued LFs (ASM only, see 20_rx_ring_uart.asm)
+uint16_t lfq_buf[LFQ_SIZE];
+uint8_t lfq_rd;
+uint8_t lfq_wr;
+uint8_t lfq_over;
+uint16_t lfq_mark;
 uint16_t rx_pos;
 uint16_t rx_last_len;
 uint8_t rx_overflow;             // Flag for ASM access (0 or 1)
+RxStats rx_stats;
+uint16_t rx_burst_lost;          // Lines lost since the last "[n lines lost]"
+uint8_t scroll_count;            // Bumped by scroll_main_zone (parse budget cost)
 
 // TIMEOUT_* values are defined in spectalk.h (single source of truth)
 
@@ -325,6 +347,9 @@ void flush_all_rx_buffers(void)
     uart_drain_to_buffer();
     uart_drain_limit = saved;
     rb_tail = rb_head;
+#ifdef ST_BANK128
+    bank_tail = bank_head;
+#endif
 
     // 3. Clear line parser state
     rx_line[0] = 0;
@@ -332,6 +357,18 @@ void flush_all_rx_buffers(void)
     rx_overflow = 0;
 }
 
+// Unread RX bytes against the BUFFER_* thresholds, shared by the MORE prompt
+// and rx_loss_tick(). The bank ring is 8x deeper: its fill is scaled onto the
+// same 2 KB, rounded up so any pending byte still reads non-zero.
+uint16_t rx_backlog(void)
+{
+    uint16_t n = (rb_head - rb_tail) & RING_BUFFER_MASK;
+#ifdef ST_BANK128
+    if (bank_ok) n = (n + ((bank_head - bank_tail) & BANK_RING_MASK) + 7) >> 3;
+#endif
+    return n;
+}
+
 void names_print_summary(uint8_t incomplete) __z88dk_fastcall
 {
     char buf[8];
@@ -388,7 +425,11 @@ uint8_t caps_latch;
 // =============================================================================
 char irc_server[IRC_SERVER_SIZE];
 char irc_port[IRC_PORT_SIZE] = "6667";
+uint8_t irc_passive;
 char irc_nick[IRC_NICK_SIZE];
+char highlight_words[HIGHLIGHT_SIZE];      // highlight= words, ',' separated
+uint8_t hl_tab[32];                        // hl_compile(): shift | 0x80 first char
+uint8_t hl_min;                            // window = shortest word, 0 = no words
 char irc_pass[IRC_PASS_SIZE];
 char nickserv_pass[IRC_PASS_SIZE];
 char nickserv_nick[IRC_NICK_SIZE];
@@ -396,10 +437,15 @@ uint8_t autoconnect;
 uint8_t autojoin;
 uint8_t autojoin_defer_flags;
 uint8_t autojoin_ident_grace;
+uint8_t cap_nin;                // CAP_NIN_* (reset per connect)
+char list_auto_chan[22];
+uint8_t list_auto_timer;
+uint8_t list_auto_wait;
 uint8_t has_esxdos;
 // friend_nicks mapped to UDG area 0xFF58 via ASM defc
 uint8_t friends_ison_sent;
 uint8_t friend_count;
+uint8_t friend_hash[MAX_FRIENDS];   // irc_hash per friend_nicks slot, 0 = empty
 char user_mode[USER_MODE_SIZE];
 char network_name[NETWORK_NAME_SIZE];
 uint8_t connection_state;
@@ -447,7 +493,9 @@ static void refresh_other_channel_activity(void)
 // IGNORE LIST
 // =============================================================================
 extern char ignore_list[MAX_IGNORES][16];  // fixed high RAM, see 00_preamble.asm
+uint8_t ignore_hash[MAX_IGNORES];          // irc_hash per ignore_list entry
 uint8_t ignore_count;
+char *irc_hash_end;                         // set by irc_hash()
 
 // Add nick to ignore list, returns 1 on success
 uint8_t add_ignore(const char *nick) __z88dk_fastcall
@@ -455,6 +503,7 @@ uint8_t add_ignore(const char *nick) __z88dk_fastcall
     if (ignore_count >= MAX_IGNORES) return 0;
     if (is_ignored(nick)) return 0;  // Already ignored
     st_copy_n(ignore_list[ignore_count], nick, sizeof(ignore_list[0]));
+    ignore_hash[ignore_count] = irc_hash(ignore_list[ignore_count]);
     ignore_count++;
     return 1;
 }
@@ -468,6 +517,7 @@ uint8_t remove_ignore(const char *nick) __z88dk_fastcall
             // Shift remaining entries
             for (j = i; j < ignore_count - 1; j++) {
                 st_copy_n(ignore_list[j], ignore_list[j + 1], sizeof(ignore_list[0]));
+                ignore_hash[j] = ignore_hash[j + 1];
             }
             ignore_count--;
             return 1;
@@ -484,13 +534,21 @@ uint8_t remove_ignore(const char *nick) __z88dk_fastcall
 static uint8_t sw_active;
 static uint8_t sw_dirty;
 
+// Copy a window name and cache its irc_hash() for find_channel/find_query.
+// Every write to ChannelInfo.name goes through here.
+void set_channel_name(ChannelInfo *ch, const char *name) __z88dk_callee
+{
+    st_copy_n(ch->name, name, sizeof(ch->name));
+    ch->hash = irc_hash(ch->name);
+}
+
 // Internal: add slot with given flags
 static int8_t add_slot_internal(const char *name, uint8_t flags) __z88dk_callee
 {
     int8_t idx = find_empty_channel_slot();
     if (idx < 0) return -1;
     
-    st_copy_n(channels[idx].name, name, sizeof(channels[0].name));
+    set_channel_name(&channels[idx], name);
     channels[idx].mode[0] = '\0';
     channels[idx].user_count = 0;
     channels[idx].flags = flags;
@@ -510,7 +568,7 @@ int8_t add_query(const char *nick) __z88dk_fastcall
 {
     // INTERCEPCIÓN DE SERVICIOS (ChanServ, NickServ)
     if (st_stricmp(nick, S_CHANSERV) == 0 || st_stricmp(nick, S_NICKSERV) == 0) {
-        st_copy_n(channels[0].name, nick, sizeof(channels[0].name));
+        set_channel_name(channels, nick);
         return 0;
     }
 
@@ -875,7 +933,7 @@ void reset_all_channels(void)
 
     // Slot 0: SIEMPRE reservado para Server / ChanServ
     channels[0].flags = CH_FLAG_ACTIVE | CH_FLAG_QUERY;  // Active + query (no user count)
-    st_copy_n(channels[0].name, S_SERVER, sizeof(channels[0].name));
+    set_channel_name(channels, S_SERVER);
 
     current_channel_idx = 0;
     cur_chan_ptr = channels;
@@ -940,6 +998,28 @@ uint8_t sntp_queried;            // Flag: valid time received (stop retrying)
 uint8_t last_frames_lo;          // Last read of FRAMES low byte
 uint16_t tick_accum;             // Frame accumulator (0-49 -> 1 second)
 
+// Main-loop overrun histogram (!status), estimated from scroll/parse cost
+FrameEst frame_est;
+uint16_t loop_cost;              // Parse units this iteration (process_irc_data)
+static uint8_t loop_scroll0;     // scroll_count at the top of the iteration
+static uint8_t frame_est_hold;   // Iteration waited on the user: not an overrun
+
+#ifdef ST_TRACE
+TraceRing trace_ring;
+#endif
+
+#ifdef ST_STACKPROBE
+StackStats stack_stats;
+
+// Probe tag for a typed line: "/server" -> 's','e'. Lowercase keeps it
+// apart from the uppercase IRC command ids in !status.
+static uint16_t stack_input_tag(const char *s) __z88dk_fastcall
+{
+    if (s[0] != '/' && s[0] != '!') return 0;
+    return ((uint16_t)(s[1] | 0x20) << 8) | (uint8_t)(s[2] | 0x20);
+}
+#endif
+
 // SCREEN STATE
 uint8_t main_line = MAIN_START;
 uint8_t main_col;
@@ -1068,14 +1148,23 @@ uint8_t pagination_pause(void)
     while ((key = in_inkey()) == 0) {
         frame_wait();
         uart_drain_to_buffer();
+#ifdef ST_BANK128
+        bank_pump();
+#endif
 
         prev_pressure = buffer_pressure;
-        backlog = (rb_head - rb_tail) & RING_BUFFER_MASK;
+        backlog = rx_backlog();
         buffer_pressure = (backlog > BUFFER_PRESSURE_THRESHOLD) ? 1 : 0;
 
         if (backlog > (RING_BUFFER_SIZE - BUFFER_CRITICAL_MARGIN)) {
             search_data_lost = 1;
-            rb_tail = rb_head;   // descarte total O(1)
+            // Every complete line thrown away counts toward "[n lines lost]".
+            // rx_ring_discard() counts them under the same IM2 hold as the cut.
+            if (rx_pos) rx_burst_lost++;
+            rx_burst_lost += rx_ring_discard();
+#ifdef ST_BANK128
+            rx_burst_lost += bank_discard();  // older bytes, staged in the bank
+#endif
             rx_pos = 0;          // FIX: Descartar línea parcial en curso
             rx_overflow = 1;     // FIX: Descartar bytes hasta próximo \n
             buffer_pressure = 0;
@@ -1084,6 +1173,7 @@ uint8_t pagination_pause(void)
         // Redibujar indicador si cambió, con throttling barato
         // FIX: Transición a 0 (presión aliviada) siempre se redibuja inmediatamente
         if (buffer_pressure != prev_pressure) {
+            if (buffer_pressure) rx_stats.pressure++;
             if (buffer_pressure == 0 || --ui_throttle == 0) {
                 ui_throttle = 8;
                 draw_status_bar_real();
@@ -1093,6 +1183,7 @@ uint8_t pagination_pause(void)
         }
     }
     while (in_inkey() != 0) { frame_wait(); uart_drain_to_buffer(); }
+    frame_est_hold = 1;    // MORE prompt time is the user's, not a lag spike
 
     if (buffer_pressure) {
         buffer_pressure = 0;
@@ -1193,9 +1284,21 @@ static void send_pending_search_command(void)
     rx_overflow = 0;  // FIX: No perder respuesta del servidor
     
     if (search_pending_type == PEND_SEARCH_CHAN) {
-        uart_send_string("LIST *");
-        uart_send_string(search_pattern);
-        uart_send_string("*\r\n");
+        // ELIST=M (or no ELIST= seen, as before): server-side *mask*.
+        // ELIST without M: full LIST, or LIST >N with U. h_numeric_322_352
+        // filters locally unless the mask was trusted.
+        uart_send_string("LIST");
+        if ((elist_caps & (ELIST_SEEN | ELIST_MASK)) != ELIST_SEEN) {
+            uart_send_string(" *");
+            uart_send_string(search_pattern);
+            uart_send_string("*");
+        } else if (search_min_users && (elist_caps & ELIST_USERS)) {
+            char buf[6];
+            u16_to_dec(buf, search_min_users);
+            uart_send_string(" >");
+            uart_send_string(buf);
+        }
+        uart_send_string("\r\n");
     } else {
         irc_send_cmd1(is_chan ? "LIST" : "WHO", search_pattern);
         if (search_pending_type == PEND_WHO ||
@@ -1881,6 +1984,211 @@ uint8_t esp_at_cmd(const char *cmd) __z88dk_fastcall
     return wait_for_response(S_OK, 30);
 }
 
+#ifdef ST_PASSIVE
+// PASSIVE RECEIVE (make passive, passive=1 / "/server host port passive")
+// AT+CIPRECVMODE=1 keeps inbound TCP data in ESP RAM; esp_pull() asks for
+// at most the free ring space with AT+CIPRECVDATA, so a burst waits on the
+// ESP instead of overflowing ring_buffer. The link is no longer transparent:
+// ay_uart_send() hands bytes to esp_tx_byte(), which queues them, and
+// esp_tx_flush() sends the queue as one AT+CIPSEND frame from the next drain.
+// The app runs with DI outside frame waits, so an AT wait that finds the
+// UART idle calls frame_wait(): FRAMES and the keyboard keep running, and
+// the wait is bounded in frames.
+#define ESP_PULL_MIN     512    // don't pull until the parser frees this much
+#define ESP_POLL_FRAMES  25     // re-ask without a +IPD notice every 0.5s
+#define ESP_WAIT_FRAMES  100    // idle frames before an AT reply is given up
+#define ESP_TX_SIZE      128    // outbound bytes batched per CIPSEND
+
+#define ESP_NONE   0
+#define ESP_LINE   1
+#define ESP_PROMPT 2
+#define ESP_DATA   3
+
+uint8_t esp_passive;
+uint8_t esp_tx_wrap;
+static uint8_t esp_tx_len;      // bytes queued in esp_tx_buf
+static uint8_t esp_rx_avail;    // +IPD seen: the ESP holds data for us
+static uint8_t esp_closed;      // CLOSED seen: hand it to the parser
+static uint8_t esp_poll_lo;
+static uint8_t esp_wait;        // idle frames left for the current AT reply
+static uint8_t esp_ln_len;
+static char esp_ln[24];
+static uint16_t esp_data_len;
+static uint8_t esp_tx_buf[ESP_TX_SIZE];
+
+// Collect one AT line from the UART. ESP_DATA stops right after the
+// "+CIPRECVDATA:<n>," (2.x) or "+CIPRECVDATA,<n>:" (1.7) header.
+static uint8_t esp_getln(void)
+{
+    int16_t c;
+
+    while ((c = uart_read_byte()) != -1) {
+        if (c == '\r') continue;
+        if (c == '\n') {
+            if (!esp_ln_len) continue;
+            esp_ln[esp_ln_len] = 0; esp_ln_len = 0;
+            return ESP_LINE;
+        }
+        if (!esp_ln_len) {
+            if (c == '>') return ESP_PROMPT;
+            if (c == ' ') continue;     // "> " prompt tail
+        }
+        if (esp_ln_len < sizeof(esp_ln) - 1) esp_ln[esp_ln_len++] = (char)c;
+        if ((c == ',' || c == ':') && esp_ln_len > 14 &&
+            !memcmp(esp_ln, "+CIPRECVDATA", 12)) {
+            esp_ln[esp_ln_len - 1] = 0; esp_ln_len = 0;
+            esp_data_len = str_to_u16(esp_ln + 13);
+            return ESP_DATA;
+        }
+    }
+    return ESP_NONE;
+}
+
+// esp_getln() for a reply we are waiting on: an idle UART costs one
+// frame_wait() from esp_wait. Callers loop while esp_wait is non-zero.
+static uint8_t esp_getln_wait(void)
+{
+    uint8_t r = esp_getln();
+
+    if (r == ESP_NONE && esp_wait) { esp_wait--; frame_wait(); }
+    return r;
+}
+
+// Unsolicited lines: "+IPD,<n>" announces data, "[<id>,]CLOSED" ends the link.
+static void esp_note(void)
+{
+    char *p = esp_ln;
+
+    if (p[0] == '+' && p[1] == 'I') { esp_rx_avail = 1; return; }
+    if (p[0] >= '0' && p[0] <= '9' && p[1] == ',') p += 2;
+    if (!strcmp(p, "CLOSED")) esp_closed = 1;
+}
+
+// Wait for the '>' prompt (tok == NULL) or a line containing tok.
+static uint8_t esp_expect(const char *tok)
+{
+    uint8_t r;
+
+    esp_wait = ESP_WAIT_FRAMES;
+    while (esp_wait) {
+        r = esp_getln_wait();
+        if (r == ESP_PROMPT && !tok) return 1;
+        if (r != ESP_LINE) continue;
+        if (esp_ln[0] == 'E' || st_stristr(esp_ln, "FAIL")) return 0;
+        if (tok && st_stristr(esp_ln, tok)) return 1;
+        esp_note();
+    }
+    return 0;
+}
+
+void esp_passive_start(void)
+{
+    esp_tx_len = 0; esp_closed = 0; esp_ln_len = 0;
+    esp_rx_avail = 1;
+    esp_passive = 1; esp_tx_wrap = 1;
+}
+
+uint8_t esp_passive_stop(void)
+{
+    uint8_t was = esp_passive;
+    if (was && connection_state >= STATE_TCP_CONNECTED) esp_tx_flush();
+    esp_passive = 0; esp_tx_wrap = 0; esp_tx_len = 0;
+    return was;
+}
+
+// One outbound byte: queue it. A full queue goes out at once; the rest
+// waits for the next drain, so a burst of lines shares one CIPSEND.
+void esp_tx_byte(uint8_t c) __z88dk_fastcall
+{
+    esp_tx_buf[esp_tx_len++] = c;
+    if (esp_tx_len == ESP_TX_SIZE) esp_tx_flush();
+}
+
+// Send the queue as one "AT+CIPSEND=<n>" frame. The exact length needs no
+// escaping and no terminator. A refused frame drops the queue.
+void esp_tx_flush(void)
+{
+    char num[6];
+    uint8_t i;
+
+    if (!esp_tx_len) return;
+    esp_tx_wrap = 0;
+    u16_to_dec(num, esp_tx_len);
+    uart_send_string("AT+CIPSEND=");
+    uart_send_line(num);
+    if (esp_expect(NULL)) {
+        for (i = 0; i < esp_tx_len; i++) ay_uart_send(esp_tx_buf[i]);
+        (void)esp_expect("SEND OK");
+    }
+    esp_tx_len = 0;
+    esp_tx_wrap = esp_passive;
+}
+
+// Copy n payload bytes into the ring through the drain body.
+static void esp_rx_copy(uint16_t n) __z88dk_fastcall
+{
+    uint16_t h;
+    uint8_t saved = uart_drain_limit;
+
+    esp_wait = ESP_WAIT_FRAMES;
+    while (n && esp_wait) {
+        h = rb_head;
+        uart_drain_limit = n > 255 ? 255 : (uint8_t)n;
+        uart_drain_raw();
+        h = (rb_head - h) & RING_BUFFER_MASK;
+        if (h) { n -= h; esp_wait = ESP_WAIT_FRAMES; }
+        else if (rb_head == ((rb_tail - 1) & RING_BUFFER_MASK)) break;
+        else { esp_wait--; frame_wait(); }
+    }
+    uart_drain_limit = saved;
+}
+
+// uart_drain_to_buffer() body while passive: send what esp_tx_byte()
+// queued, read notices, then pull what fits.
+void esp_pull(void)
+{
+    uint16_t free;
+    uint8_t r;
+    char num[6];
+
+    esp_tx_flush();
+    esp_tx_wrap = 0;
+    while ((r = esp_getln()) != ESP_NONE)
+        if (r == ESP_LINE) esp_note();
+    if (esp_closed) {
+        // The parser's CLOSED check expects a line of its own
+        const char *s = "\nCLOSED\n";
+        while (*s && rb_push(*s)) s++;
+        esp_closed = 0;
+        goto out;
+    }
+    free = (rb_tail - rb_head - 1) & RING_BUFFER_MASK;
+    if (free < ESP_PULL_MIN) goto out;
+    if (!esp_rx_avail && (uint8_t)(*FRAMES_ADDR - esp_poll_lo) < ESP_POLL_FRAMES) goto out;
+    esp_poll_lo = *FRAMES_ADDR;
+    esp_rx_avail = 0;
+
+    u16_to_dec(num, free);
+    uart_send_string("AT+CIPRECVDATA=");
+    uart_send_line(num);
+    esp_wait = ESP_WAIT_FRAMES;
+    while (esp_wait) {
+        r = esp_getln_wait();
+        if (r == ESP_DATA) {
+            if (esp_data_len >= free) esp_rx_avail = 1;    // more may wait
+            esp_rx_copy(esp_data_len);
+            esp_wait = ESP_WAIT_FRAMES;
+        } else if (r == ESP_LINE) {
+            if (esp_ln[0] == 'O' && esp_ln[1] == 'K') break;
+            if (esp_ln[0] == 'E') break;    // nothing buffered
+            esp_note();
+        }
+    }
+out:
+    esp_tx_wrap = esp_passive;
+}
+#endif
+
 // ESP/WIFI INITIALIZATION
 // OPT L1: rx_drop_buffered eliminada (no usada)
 
@@ -1914,6 +2222,9 @@ uint8_t esp_init(void)
     //    causes garbage pointers on z88dk/SDCC, see audit C01)
     esp_hard_cmd(S_AT_CIPMODE0);
     esp_hard_cmd(S_AT_CIPCLOSE);
+#ifdef ST_PASSIVE
+    esp_hard_cmd("AT+CIPRECVMODE=0");
+#endif
     esp_hard_cmd("ATE0");
     esp_hard_cmd(S_AT_CIPSERVER0);
     esp_hard_cmd(S_AT_CIPMUX0);
@@ -2009,13 +2320,21 @@ void force_disconnect(void)
     
     if (disconnecting_in_progress) return;
     disconnecting_in_progress = 1;
+#ifdef ST_TRACE
+    trace_ev(connection_state, TR_DISCONNECT);
+#endif
 
     if (overlay_mode == OVERLAY_ABOUT) {
         overlay_call(1);       /* close ABOUT DAT before ring_buffer is reused */
         overlay_exit_full();
     }
     
+#ifdef ST_PASSIVE
+    // A passive link was never transparent: no +++ escape to send
+    if (connection_state >= STATE_TCP_CONNECTED && !esp_passive_stop()) {
+#else
     if (connection_state >= STATE_TCP_CONNECTED) {
+#endif
         // No QUIT here: sending QUIT before reconnect triggers server-side
         // throttle (many servers delay 001 for 30-120s after clean QUIT+reconnect).
         // Ghost nick clears itself via server ping timeout (~120s).
@@ -2031,6 +2350,9 @@ void force_disconnect(void)
     
     uart_send_line(S_AT_CIPMODE0);
     (void)wait_for_response(S_OK, 50);
+#ifdef ST_PASSIVE
+    (void)esp_at_cmd("AT+CIPRECVMODE=0");
+#endif
 
     connection_state = STATE_WIFI_OK;
     closed_reported = 0;
@@ -2132,6 +2454,55 @@ void irc_check_friends_online(void)
     irc_send_cmd1("ISON", rx_line);
 }
 
+// Walk irc_nick, then each ','-separated word of highlight_words. Pass 0
+// finds the Horspool window (shortest word), pass 1 fills hl_tab.
+static void hl_walk(uint8_t fill) __z88dk_fastcall
+{
+    const char *w = irc_nick;
+    const char *next = highlight_words;
+    uint8_t n, i, s, *t;
+
+    for (;;) {
+        n = 0;
+        while (w[n] && w[n] != ',') n++;
+        if (n) {
+            if (!fill) {
+                if (n < hl_min) hl_min = n;
+            } else {
+                hl_tab[w[0] & 31] |= 0x80;
+                for (i = 0; i < hl_min; i++) {
+                    t = &hl_tab[w[i] & 31];
+                    s = hl_min - 1 - i;
+                    if (s < (*t & 0x3F)) *t = (*t & 0x80) | s;
+                }
+            }
+        }
+        w += n;
+        if (*w) w++;
+        else if (next) { w = next; next = 0; }
+        else break;
+    }
+}
+
+// Compile the mention matcher used by hl_match(). hl_tab is indexed by
+// (c & 31), which folds case the same way irc_tolower() does; a bucket's
+// shift is the minimum over every byte that lands in it, so it never skips
+// a match. Runs on nick change and config load only.
+void hl_compile(void)
+{
+    hl_min = 0xFF;
+    hl_walk(0);
+    if (hl_min == 0xFF) { hl_min = 0; return; }
+    memset(hl_tab, hl_min, sizeof(hl_tab));
+    hl_walk(1);
+}
+
+void set_irc_nick(const char *nick) __z88dk_fastcall
+{
+    st_copy_n(irc_nick, nick, sizeof(irc_nick));
+    hl_compile();
+}
+
 // OPT-P2-B: Shared nick-in-use retry logic (dedup h_numeric_433 + cmd_connect)
 void nick_try_alternate(void)
 {
@@ -2148,6 +2519,7 @@ void nick_try_alternate(void)
         irc_nick[len] = '_';
         irc_nick[len + 1] = '\0';
     }
+    hl_compile();
 
     set_attr_sys();
     main_puts(S_NICK_INUSE);
@@ -2542,13 +2914,14 @@ static void cfg_apply(char *key, char *val) __z88dk_callee {
         if (k1 == 'p') cfg_s(nickserv_pass, IRC_PASS_SIZE);
         else if (k1 == 'c') cfg_b(&nick_color_mode);
         else if (k1 == 's') cfg_s(nickserv_nick, IRC_NICK_SIZE);
-        else cfg_s(irc_nick, IRC_NICK_SIZE);
+        else set_irc_nick(val);
     } else if (k0 == 's' && k1 == 'e') {    // server
         cfg_s(irc_server, IRC_SERVER_SIZE);
     } else if (k0 == 'p' && k1 == 'o') {    // port
         cfg_s(irc_port, IRC_PORT_SIZE);
-    } else if (k0 == 'p' && k1 == 'a') {    // pass
-        cfg_s(irc_pass, IRC_PASS_SIZE);
+    } else if (k0 == 'p' && k1 == 'a') {    // pass / passive
+        if (cfg_key4(key)) cfg_b(&irc_passive);
+        else cfg_s(irc_pass, IRC_PASS_SIZE);
     } else if (k0 == 't' && k1 == 'h') {    // theme
         uint8_t v = (uint8_t)str_to_u16(val);
         if ((uint8_t)(v - 1) <= 2) current_theme = v;  // PD4: underflow trick
@@ -2563,9 +2936,26 @@ static void cfg_apply(char *key, char *val) __z88dk_callee {
     } else if (k0 == 'f' && k1 == 'r') {  // friends
         uint8_t idx = 0;
         char *tok, *p = val;
-        while (idx < MAX_FRIENDS && (tok = csv_next_tok(&p)) != NULL)
-            st_copy_n(friend_nicks[idx++], tok, IRC_NICK_SIZE);
+        while (idx < MAX_FRIENDS && (tok = csv_next_tok(&p)) != NULL) {
+            st_copy_n(friend_nicks[idx], tok, IRC_NICK_SIZE);
+            friend_hash[idx] = irc_hash(friend_nicks[idx]);
+            idx++;
+        }
         friend_count = idx;
+    } else if (k0 == 'h' && k1 == 'i') {  // highlight: re-join trimmed words
+        char *tok, *p = val, *d = highlight_words;
+        uint8_t left;
+        while ((tok = csv_next_tok(&p)) != NULL) {
+            left = (uint8_t)(highlight_words + HIGHLIGHT_SIZE - d);
+            if (d != highlight_words) {
+                if (left < 3) break;
+                *d++ = ',';
+                left--;
+            }
+            st_copy_n(d, tok, left);
+            while (*d) d++;
+        }
+        hl_compile();
     } else if (k0 == 'i' && k1 == 'g') {  // ignores
         char *tok, *p = val;
         while (ignore_count < MAX_IGNORES && (tok = csv_next_tok(&p)) != NULL)
@@ -2678,6 +3068,15 @@ void main(void)
     uint8_t cfg_ok;
     uint8_t can_autoconnect;
     
+#ifdef ST_STACKPROBE
+    stack_paint();
+#endif
+#ifdef ST_IM2
+    im2_setup();
+#endif
+#ifdef ST_BANK128
+    bank_setup();
+#endif
     has_esxdos = esx_detect();
 
     // Fatal: no divMMC/esxDOS
@@ -2801,6 +3200,24 @@ void main(void)
             uint8_t elapsed = now_lo - last_frames_lo;  // wraps correctly (uint8)
             last_frames_lo = now_lo;
             tick_accum += elapsed;
+            // Overrun estimate: 1, 2, 3-4, 5-8, >8 frames per iteration.
+            // Under DI the HALT above sees one interrupt however long the
+            // iteration ran, so the scroll/parse estimate (1/8 frames) is
+            // charged on top of that frame when it says more.
+            if (elapsed && !frame_est_hold) {
+                uint16_t est = (uint16_t)(uint8_t)(scroll_count - loop_scroll0) * RX_COST_SCROLL +
+                               loop_cost;
+                uint8_t b;
+                est = (est >> 3) + 1;
+                if (est < elapsed) est = elapsed;
+                b = (est <= 2) ? (uint8_t)est - 1 :
+                    (est <= 4) ? 2 : (est <= 8) ? 3 : 4;
+                frame_est.hist[b]++;
+                if (est > frame_est.worst) frame_est.worst = est;
+            }
+            frame_est_hold = 0;
+            loop_scroll0 = scroll_count;
+            loop_cost = 0;
             // Post-cancel quiet window (suppresses h_default_cmd garbage from
             // residuos de lista cancelada). Decremento independiente de ticks.
             if (post_cancel_quiet) {
@@ -2933,6 +3350,9 @@ void main(void)
                     }
                 } else if (server_silence_frames >= KEEPALIVE_SILENCE_FRAMES && !pagination_active) {
                     // No server activity for too long - send PING to check
+#ifdef ST_TRACE
+                    trace_ev(server_silence_frames, TR_PING);
+#endif
                     uart_send_string("PING :keepalive\r\n");
                     keepalive_ping_sent = 1;
                     keepalive_timeout = 0;
@@ -2940,6 +3360,9 @@ void main(void)
                 } else if (lagmeter_counter >= LAGMETER_INTERVAL_FRAMES && 
                            !pagination_active && !buffer_pressure) {
                     // Periodic lag measurement (postponed during heavy traffic)
+#ifdef ST_TRACE
+                    trace_ev(server_silence_frames, TR_PING);
+#endif
                     uart_send_string("PING :lag\r\n");
                     keepalive_ping_sent = 1;
                     keepalive_timeout = 0;
@@ -2960,9 +3383,14 @@ void main(void)
                     uart_drain_to_buffer();
                     
                     // pending == 0  <=> ring vacío y sin línea parcial
-                    if (rx_pos == 0 && rb_head == rb_tail) {
-                        // Buffer vacío - contar frames estables
-                        if (++search_flush_stable >= 10) {
+                    if (rx_pos == 0 && rb_head == rb_tail
+#ifdef ST_BANK128
+                        && bank_head == bank_tail
+#endif
+                        ) {
+                        // Buffer vacío - contar frames estables. A silent
+                        // LIST still in flight keeps 321/323 until it ends.
+                        if (++search_flush_stable >= 10 && !list_auto_chan[0]) {
                             // Drenaje completo - enviar comando
                             search_flush_state = 2;
                             flush_all_rx_buffers();
@@ -2977,7 +3405,8 @@ void main(void)
                         // Timeout solo cuando hay datos persistentes (~3s).
                         // Flush final antes de enviar nuevo LIST para evitar
                         // basura residual de listado previo rendering en main area.
-                        if (++pagination_timeout > PAGINATION_FLUSH_TIMEOUT_FRAMES) {
+                        if (++pagination_timeout > PAGINATION_FLUSH_TIMEOUT_FRAMES &&
+                            !list_auto_chan[0]) {
                             search_flush_state = 2;
                             flush_all_rx_buffers();
                             send_pending_search_command();
@@ -3236,6 +3665,9 @@ void main(void)
                             deferred_wrap_step();
                         }
                         parse_user_input(temp_input);
+#ifdef ST_STACKPROBE
+                        stack_probe(stack_input_tag(temp_input));
+#endif
                         cursor_show();
                      }
                 }
@@ -3272,7 +3704,19 @@ void main(void)
                     process_irc_data();
                 }
                 count_sync_tick();
+                // No 323 (error numeric, reply flushed): give the window back
+                if (list_auto_chan[0] && !--list_auto_timer) {
+                    list_auto_chan[0] = 0;
+                    list_auto_wait = 1;
+                }
+                if (list_auto_wait) list_auto_retry();
+#ifdef ST_RECORD
+                if (rec_handle) rec_pump();
+#endif
             }
+#ifdef ST_STACKPROBE
+            stack_probe(0);
+#endif
         }
     }
 }
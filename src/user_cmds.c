@@ -50,6 +50,7 @@ static const char K_CFG_ALT[]  = "/SYS/SPECTALK.CFG";
 static const char K_TZ[]       = "tz=";
 static const char K_NOTIF[]    = "notif=";
 static const char K_COUNTSYNC[] = "countsync=";
+static const char K_PASSIVE[]  = "passive=";
 
 // PD1: cut_at_space() removed — split_at_space() does same buffer cut
 
@@ -309,6 +310,9 @@ static void cmd_connect(const char *args) __z88dk_fastcall
     uint8_t result;
     uint8_t use_ssl = 0;
     uint8_t use_saved_session = 0;
+#ifdef ST_PASSIVE
+    uint8_t passive_ok = 0;
+#endif
 
     if (connection_state < STATE_WIFI_OK) {
         ui_err("No WiFi. Use !init");
@@ -328,7 +332,7 @@ static void cmd_connect(const char *args) __z88dk_fastcall
             use_saved_session = 1;
             goto do_connect;
         }
-        ui_usage("server host [port]");
+        ui_usage("server host [port [passive]]");
         return;
     }
 
@@ -354,6 +358,13 @@ static void cmd_connect(const char *args) __z88dk_fastcall
     if (!port || !*port) port = S_DEFAULT_PORT;
     if (strchr(irc_server, '"')) { ui_err("Bad server name"); return; }  // audit L04
 
+    // "host port passive": the flag travels with server/port (config, bookmarks)
+    sep = strchr(port, ' ');
+    irc_passive = 0;
+    if (sep) {
+        *sep = '\0';
+        irc_passive = (*skip_spaces(sep + 1) == 'p');
+    }
     st_copy_n(irc_port, port, sizeof(irc_port));
 
 do_connect:
@@ -385,6 +396,12 @@ do_connect:
     esp_at_cmd("AT+CIPDINFO=0");
     if (use_ssl) { esp_at_cmd("AT+CIPSSLSIZE=4096"); }
 
+    // irc_passive asks for a passive-receive link (make passive). Other
+    // builds, and firmwares without AT+CIPRECVMODE, connect transparently.
+#ifdef ST_PASSIVE
+    if (irc_passive) passive_ok = esp_at_cmd("AT+CIPRECVMODE=1");
+#endif
+
     // If the WiFi-idle SNTP path has not produced a clock yet, use raw UDP NTP
     // before opening the IRC TCP link. This also covers old AT firmwares that
     // lack CIPSNTPTIME.
@@ -408,6 +425,12 @@ do_connect:
 
     wait_drain(20);
     rb_tail = rb_head; rx_pos = 0;
+#ifdef ST_BANK128
+    bank_tail = bank_head;
+#endif
+#ifdef ST_PASSIVE
+    if (passive_ok) { esp_passive_start(); goto link_up; }
+#endif
 
     uart_send_line("AT+CIPMODE=1");
     if (!wait_for_response(S_OK, 100)) { ui_err("CIPMODE FAIL"); goto connect_fail; }
@@ -426,7 +449,10 @@ do_connect:
         }
         ui_err("No '>' prompt"); goto connect_fail;
     }
-    
+
+#ifdef ST_PASSIVE
+link_up:
+#endif
     connection_state = STATE_TCP_CONNECTED; closed_reported = 0;
     rx_pos = 0; rx_overflow = 0;
     
@@ -441,6 +467,11 @@ do_connect:
         
         set_attr_priv(); main_puts("Registering... ");
         
+        cap_nin = 0;
+        elist_caps = 0;
+        list_auto_chan[0] = 0;
+        list_auto_wait = 0;
+        uart_send_line("CAP LS 302");   // h_cap(): REQ draft/no-implicit-names
         if (irc_pass[0]) irc_send_cmd1("PASS", irc_pass);
         irc_send_cmd1(S_NICK_CMD, irc_nick);
         uart_send_string("USER "); uart_send_string(irc_nick); 
@@ -490,18 +521,10 @@ do_connect:
                     }
                 }
                 
-                // CAP LS - format: ":server CAP * LS ..."
-                if (line[0] == ':' && sp) {
-                    // Check for LS after CAP
-                    char *ls = cap_params_start(sp);
-                    if (ls) {
-                        ls = skip_spaces(ls);
-                        if (*ls == '*') { ls++; ls = skip_spaces(ls); }
-                        if (ls[0] == 'L' && ls[1] == 'S') {
-                            uart_send_line(S_CAP_END);
-                            rx_pos = 0; continue;
-                        }
-                    }
+                // CAP - format: ":server CAP * LS|ACK|NAK ..." -> h_cap()
+                if (line[0] == ':' && sp && cap_params_start(sp)) {
+                    parse_irc_message(line);
+                    rx_pos = 0; continue;
                 }
                 
                 // PING
@@ -744,7 +767,7 @@ static void cmd_nick(const char *args) __z88dk_fastcall
         irc_send_cmd1(S_NICK_CMD, p);
     } else {
         // Desconectado: Actualizar inmediatamente
-        st_copy_n(irc_nick, p, sizeof(irc_nick));
+        set_irc_nick(p);
 
         notify2("Nick set to ", irc_nick, ATTR_MSG_SYS);
         draw_status_bar();
@@ -1073,7 +1096,14 @@ static void cmd_whois(const char *args) __z88dk_fastcall
 static void cmd_list(const char *args) __z88dk_fastcall
 {
     if (!check_status(LVL_IRC)) return;
-    if (!args || !*args) { ui_usage("list #channel"); main_print("(Full list disabled)"); return; }
+    if (!args || !*args) { ui_usage("list #channel or >users"); main_print("(Full list disabled)"); return; }
+
+    search_min_users = 0;
+    if (args[0] == '>') {
+        // Server-side only: without ELIST=U this is the full list
+        if (!(elist_caps & ELIST_USERS)) { ui_err("Server lacks ELIST=U"); return; }
+        search_min_users = str_to_u16(args + 1);
+    }
 
     sys_puts_print("LIST: ", args);
     start_search_command(PEND_LIST, args);
@@ -1169,7 +1199,7 @@ static void cmd_search(const char *args) __z88dk_fastcall
     uint8_t is_chan;
     uint8_t len;
 
-    if (!ensure_args(args, "search #pattern or nick")) return;
+    if (!ensure_args(args, "search #pattern [>users] or nick")) return;
     if (!check_status(LVL_IRC)) return;
 
     // args proviene de cmd_copy/line_buffer que es RAM escriturable.
@@ -1189,7 +1219,12 @@ static void cmd_search(const char *args) __z88dk_fastcall
     end = src;
     len = 0;
     while (*end && *end != ' ' && len < SEARCH_PATTERN_SIZE - 1) { end++; len++; }
-    if (*end) *end = '\0';
+    search_min_users = 0;
+    if (*end) {
+        char *opt = skip_spaces(end + 1);
+        *end = '\0';
+        if (opt[0] == '>') search_min_users = str_to_u16(opt + 1);
+    }
 
     set_attr_sys();
     if (is_chan) {
@@ -1246,7 +1281,9 @@ static void enter_overlay_mode(uint8_t m) __z88dk_fastcall
 
 static void sys_status(const char *args) __z88dk_fastcall
 {
-    (void)args;
+    // SPCTLK4 reads "!status reset" from overlay_slot.
+    overlay_slot[0] = 0;
+    if (args) st_copy_n((char *)overlay_slot, args, 8);
     enter_overlay_mode(OVERLAY_STATUS);
     overlay_exec(3, 0);
 }
@@ -1278,6 +1315,9 @@ static void sys_init(const char *args) __z88dk_fastcall
     
     set_attr_priv();
     main_puts("Re-initializing ESP... ");
+#ifdef ST_PASSIVE
+    (void)esp_passive_stop();
+#endif
     
     flush_all_rx_buffers(); 
     uart_send_line(S_AT_CMD);  // OPT M7
@@ -1482,6 +1522,181 @@ void cmd_save(const char *args) __z88dk_fastcall
 
 // OPT-C14: cmd_clear eliminated — command table points directly to clear_main
 
+#ifdef ST_RECORD
+// ============================================================
+// SESSION RECORDER (make record): !record [file]
+// ============================================================
+// Tees every byte the RX ring accepts into an SRX1 file (20 ms ticks), the
+// format tools/zxbench.py replays. ring_buffer is the write-behind buffer:
+// bytes from rec_tail to rb_head are not on SD yet and the drain will not
+// overwrite them. rec_pump() notes one (head, FRAMES) mark per main-loop pass
+// and writes the marks as records only once the parser has caught up and no
+// byte arrived for a whole pass. A full ring never waits for SD: rec_give_up
+// (20_rx_ring_uart.asm) drops the already parsed bytes and counts rec_lost.
+
+#define REC_MARKS   8
+#define REC_FRAMES  (*(volatile uint16_t *)23672)
+
+static const char K_REC_MAGIC[] = "SRX1\x14";   // + tick length: 20 ms
+static const char K_REC_FILE[]  = "SESSION.SRX";
+
+uint8_t rec_handle;              // esxDOS handle, 0 = not recording
+uint16_t rec_tail;               // Ring offset of the oldest byte not on SD
+uint16_t rec_lost;               // Bytes dropped from the file on a full ring
+uint8_t rec_marks;               // Used entries in rec_mark_end/rec_mark_at
+static uint16_t rec_mark_end[REC_MARKS];  // Ring offset where a record ends
+static uint16_t rec_mark_at[REC_MARKS];   // FRAMES when that end was seen
+static uint16_t rec_last_at;     // FRAMES stamp of the previous record
+static uint16_t rec_seen_head;   // rb_head at the previous rec_pump()
+static uint16_t rec_kb;          // Bytes written, in KB ...
+static uint16_t rec_bytes;       // ... plus remainder
+static uint8_t rec_error;
+
+static void rec_write(uint16_t buf, uint16_t n)
+{
+    esx_buf = buf;
+    esx_count = n;
+    esx_fwrite();
+    if (esx_result != n) rec_error = 1;
+}
+
+static void rec_mark(void)
+{
+    uint16_t h = rb_head;
+    uint8_t n = rec_marks;
+    if (h == (n ? rec_mark_end[n - 1] : rec_tail)) return;
+    if (n == REC_MARKS) {
+        n--;                     // out of marks: stretch the last record
+    } else {
+        rec_mark_at[n] = REC_FRAMES;
+    }
+    rec_mark_end[n] = h;
+    rec_marks = n + 1;
+}
+
+static void rec_close(void)
+{
+    esx_handle = rec_handle;
+    esx_fclose();
+    rec_handle = 0;
+}
+
+// Write every pending mark as an SRX1 record. Also called by overlay_exec()
+// before an overlay load overwrites ring_buffer.
+void rec_flush(void)
+{
+    uint8_t saved = esx_handle;
+    uint16_t start = rec_tail;
+    uint8_t i;
+
+    if (!rec_handle) return;
+    rec_mark();
+    esx_handle = rec_handle;
+    for (i = 0; i < rec_marks; i++) {
+        uint16_t hdr[2];
+        uint16_t len = (rec_mark_end[i] - start) & RING_BUFFER_MASK;
+        // Marks behind a rec_give_up() jump measure past rb_head: skip them.
+        if (len == 0 || len > ((rb_head - start) & RING_BUFFER_MASK)) continue;
+        hdr[0] = rec_mark_at[i] - rec_last_at;
+        hdr[1] = len;
+        rec_last_at = rec_mark_at[i];
+        rec_write((uint16_t)hdr, 4);
+        if (start + len > RING_BUFFER_SIZE) {
+            uint16_t first = RING_BUFFER_SIZE - start;
+            rec_write((uint16_t)ring_buffer + start, first);
+            rec_write((uint16_t)ring_buffer, len - first);
+        } else {
+            rec_write((uint16_t)ring_buffer + start, len);
+        }
+        start = rec_mark_end[i];
+        rec_bytes += len;
+        while (rec_bytes >= 1024) { rec_bytes -= 1024; rec_kb++; }
+    }
+    rec_marks = 0;
+    rec_tail = start;
+    esx_handle = saved;
+    if (rec_error) {
+        rec_close();
+        ui_err("Record write error");
+    }
+}
+
+// Main loop, once per pass: mark new bytes, write them when the line is quiet.
+static void rec_pump(void)
+{
+    uint16_t h = rb_head;
+    if (h == rec_tail) {
+        rec_marks = 0;
+    } else if (h == rec_seen_head && h == rb_tail) {
+        rec_flush();
+    } else {
+        rec_mark();
+    }
+    rec_seen_head = h;
+}
+
+static void cmd_record(const char *args) __z88dk_fastcall
+{
+    char buf[6];
+    if (rec_handle) {
+        rec_flush();
+        if (!rec_handle) return;
+        rec_close();
+        u16_to_dec(buf, rec_kb);
+        sys_puts_print("Recorded KB: ", buf);
+        u16_to_dec(buf, rec_lost);
+        sys_puts_print("Bytes lost: ", buf);
+        return;
+    }
+    if (!args || !*args) args = K_REC_FILE;
+    esx_fcreate(args);
+    if (!esx_handle) { ui_err("Cannot create file"); return; }
+    rec_handle = esx_handle;
+    rec_tail = rec_seen_head = rb_head;
+    rec_marks = 0;
+    rec_lost = rec_kb = rec_bytes = 0;
+    rec_error = 0;
+    rec_last_at = REC_FRAMES;
+    rec_write((uint16_t)K_REC_MAGIC, 5);
+    sys_puts_print("Recording to ", args);
+}
+#endif
+
+#ifdef ST_TRACE
+// ============================================================
+// EVENT TRACE DUMP (make trace): !trace [file]
+// ============================================================
+// Writes "STT1" and then trace_ring as it sits in RAM: the head byte and
+// TRACE_RECORDS 4-byte records. tools/zxtrace.py prints it as a timeline.
+// The ring keeps running; a later !trace overwrites the file.
+
+static const char K_TRACE_MAGIC[] = "STT1";
+static const char K_TRACE_FILE[]  = "TRACE.BIN";
+
+static void cmd_trace(const char *args) __z88dk_fastcall
+{
+    uint8_t saved = esx_handle;
+    uint8_t ok;
+
+    trace_ev(trace_ring.head, TR_DUMP);
+    if (!args || !*args) args = K_TRACE_FILE;
+    esx_fcreate(args);
+    if (!esx_handle) { esx_handle = saved; ui_err("Cannot create file"); return; }
+    esx_buf = (uint16_t)K_TRACE_MAGIC;
+    esx_count = 4;
+    esx_fwrite();
+    ok = (esx_result == 4);
+    esx_buf = (uint16_t)&trace_ring;
+    esx_count = sizeof(trace_ring);
+    esx_fwrite();
+    if (esx_result != sizeof(trace_ring)) ok = 0;
+    esx_fclose();
+    esx_handle = saved;
+    if (!ok) { ui_err("Trace write error"); return; }
+    sys_puts_print("Trace saved to ", args);
+}
+#endif
+
 
 // ============================================================
 // COMMAND DISPATCHER
@@ -1535,7 +1750,17 @@ typedef struct {
 static void sys_help(const char *args) __z88dk_fastcall;
 
 #define CMD_IDX_NONE  ((uint8_t)0xFF)
-#define SYS_CMDS_COUNT 23
+#ifdef ST_RECORD
+#define SYS_CMDS_REC 1
+#else
+#define SYS_CMDS_REC 0
+#endif
+#ifdef ST_TRACE
+#define SYS_CMDS_TRACE 1
+#else
+#define SYS_CMDS_TRACE 0
+#endif
+#define SYS_CMDS_COUNT (23 + SYS_CMDS_REC + SYS_CMDS_TRACE)
 
 // Command names/aliases pool (help strings moved to /SYS/SPECTALK.HLP)
 static const char cmd_pool[] =
@@ -1546,6 +1771,12 @@ static const char cmd_pool[] =
     "save\0sv\0autoconnect\0ac\0tz\0friend\0nickcolor\0nc\0notif\0nf\0"
     "changelog\0click\0mode\0reply\0notice\0autojoin\0divider\0countsync\0cs\0"
     "bookmarks\0bm\0"
+#ifdef ST_RECORD
+    "record\0rec\0"
+#endif
+#ifdef ST_TRACE
+    "trace\0"
+#endif
 ;
 
 static const PackedCmd USER_COMMANDS[] = {
@@ -1573,6 +1804,12 @@ static const PackedCmd USER_COMMANDS[] = {
     {  66,  67, cmd_countsync },
     {  60, 255, cmd_click },
     {  68,  69, cmd_bookmarks },
+#ifdef ST_RECORD
+    {  70,  71, cmd_record },
+#endif
+#ifdef ST_TRACE
+    {  70 + 2 * SYS_CMDS_REC, 255, cmd_trace },
+#endif
     // --- IRC commands (/ prefix) ---
     {  10,  11, cmd_connect_retry },
     {  12, 255, cmd_nick },
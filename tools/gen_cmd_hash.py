@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+"""
+Generate cmd_hash.h: a collision-free hash over the CMD_TABLE ids.
+
+Usage: python tools/gen_cmd_hash.py
+Reads:  src/cmd_table.inc (CMD_TABLE rows, in order)
+Writes: include/cmd_hash.h
+
+cmd_id is either a numeric (hi 0..3) or two uppercase letters (hi, lo). The
+hash is hash-and-displace over the two bytes, all 8-bit shifts and adds:
+
+    g    = (uint8_t)(lo ^ (hi << T)) >> U & (NB - 1)
+    slot = (uint8_t)(lo + (hi << S) + CMD_DISP[g]) & MASK
+    CMD_SLOT[slot] = CMD_TABLE index + 1, 0 = no handler
+
+The first CMD_TABLE row is also emitted as CMD_HOT_ID and tested with one
+16-bit compare before the probe, so PRIVMSG stays cheaper than a hash.
+
+parse_irc_message() still compares CMD_TABLE[i].id, so an id outside the
+table (any unknown numeric) costs one probe and falls through to the default
+handlers. Adding a row only needs a rerun; the search widens NB and MASK when
+the table outgrows 8 buckets / 64 slots.
+
+The rows file is not a BPE input, so the header only changes with the table.
+Dispatch cost is measured on the built TAP: make cmdbench.
+"""
+
+import argparse
+import re
+import sys
+from collections import Counter
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parent.parent
+TABLE = ROOT / "src" / "cmd_table.inc"
+OUT = ROOT / "include" / "cmd_hash.h"
+
+ROW_RE = re.compile(r"\{\s*(0x[0-9A-Fa-f]+|\d+)\s*,\s*(\w+)\s*\}")
+
+
+def read_rows(path):
+    text = path.read_text(encoding="utf-8", errors="replace")
+    text = re.sub(r"//[^\n]*", "", text)
+    rows = [(int(i, 0), fn) for i, fn in ROW_RE.findall(text)]
+    ids = [i for i, _ in rows]
+    dup = [i for i, n in Counter(ids).items() if n > 1]
+    if dup:
+        raise SystemExit("CMD_TABLE: duplicate id %s" % ", ".join(map(hex, dup)))
+    if not rows:
+        raise SystemExit("CMD_TABLE: no rows found in %s" % path)
+    return rows
+
+
+def bucket(i, nb, t, u):
+    lo, hi = i & 255, i >> 8
+    return ((lo ^ ((hi << t) & 255)) >> u) & (nb - 1)
+
+
+def base(i, s):
+    lo, hi = i & 255, i >> 8
+    return (lo + (hi << s)) & 255
+
+
+def place(ids, nb, mask, s, t, u):
+    """Displacement per bucket, largest buckets first; None if stuck."""
+    buckets = {}
+    for i in ids:
+        buckets.setdefault(bucket(i, nb, t, u), []).append(base(i, s))
+    used = set()
+    disp = [0] * nb
+    for g, vs in sorted(buckets.items(), key=lambda kv: (-len(kv[1]), kv[0])):
+        for d in range(mask + 1):
+            slots = {(v + d) & mask for v in vs}
+            if len(slots) == len(vs) and not slots & used:
+                used |= slots
+                disp[g] = d
+                break
+        else:
+            return None
+    return disp
+
+
+def shift_cost(s, t, u):
+    """add a,a per left shift; srl a per right shift, or rlca + the and."""
+    return 4 * s + 4 * t + min(8 * u, 4 * (8 - u))
+
+
+def search(ids):
+    """Smallest tables first, then the cheapest shifts (shift_cost)."""
+    for mask in (63, 127, 255):
+        if len(ids) > mask + 1:
+            continue
+        for nb in (8, 16, 32):
+            best = None
+            for s in range(8):
+                for t in range(8):
+                    for u in range(8 - (nb.bit_length() - 1) + 1):
+                        disp = place(ids, nb, mask, s, t, u)
+                        if disp is None:
+                            continue
+                        key = (shift_cost(s, t, u), s, t, u)
+                        if best is None or key < best[0]:
+                            best = (key, s, t, u, disp)
+            if best:
+                _, s, t, u, disp = best
+                return dict(nb=nb, mask=mask, s=s, t=t, u=u, disp=disp)
+    raise SystemExit("no collision-free hash for %d ids" % len(ids))
+
+
+def slot_of(i, h):
+    g = bucket(i, h["nb"], h["t"], h["u"])
+    return (base(i, h["s"]) + h["disp"][g]) & h["mask"]
+
+
+def build(rows):
+    ids = [i for i, _ in rows]
+    h = search(ids)
+    slots = [0] * (h["mask"] + 1)
+    for n, i in enumerate(ids):
+        k = slot_of(i, h)
+        assert slots[k] == 0
+        slots[k] = n + 1
+    h["slots"] = slots
+    return h
+
+
+def id_name(i):
+    if i < 1000:
+        return "%03d" % i
+    return chr(i >> 8) + chr(i & 255)
+
+
+def fmt_bytes(vals, per_line=16):
+    lines = []
+    for k in range(0, len(vals), per_line):
+        lines.append("    " + ", ".join("%2d" % v for v in vals[k:k + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def render(rows, h):
+    out = [
+        "// Generated by tools/gen_cmd_hash.py from src/cmd_table.inc.",
+        "// Do not edit: reorder or add CMD_TABLE rows, then run make (or the script).",
+        "#ifndef CMD_HASH_H",
+        "#define CMD_HASH_H",
+        "",
+        "#define CMD_HASH_ROWS  %d" % len(rows),
+        "#define CMD_HOT_ID     0x%04X  // CMD_TABLE[0], compared before the probe" % rows[0][0],
+        "#define CMD_HASH_MASK  %d" % h["mask"],
+        "#define CMD_HASH_NB    %d" % h["nb"],
+        "#define CMD_HASH_S     %d" % h["s"],
+        "#define CMD_HASH_T     %d" % h["t"],
+        "#define CMD_HASH_U     %d" % h["u"],
+        "",
+        "// Slot for cmd_id bytes (lo, hi); CMD_SLOT holds CMD_TABLE index + 1.",
+        "#define CMD_HASH(lo, hi) ((uint8_t)((lo) + (uint8_t)((hi) << CMD_HASH_S) + \\",
+        "    CMD_DISP[(uint8_t)((lo) ^ (uint8_t)((hi) << CMD_HASH_T)) >> CMD_HASH_U & (CMD_HASH_NB - 1)]) & CMD_HASH_MASK)",
+        "",
+        "static const uint8_t CMD_DISP[CMD_HASH_NB] = {",
+        fmt_bytes(h["disp"]),
+        "};",
+        "",
+        "// " + " ".join("%s@%d" % (id_name(i), slot_of(i, h)) for i, _ in rows[:12]),
+    ]
+    for k in range(12, len(rows), 12):
+        out.append("// " + " ".join("%s@%d" % (id_name(i), slot_of(i, h)) for i, _ in rows[k:k + 12]))
+    out += [
+        "static const uint8_t CMD_SLOT[CMD_HASH_MASK + 1] = {",
+        fmt_bytes(h["slots"]),
+        "};",
+        "",
+        "#endif",
+        "",
+    ]
+    return "\n".join(out)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    ap.add_argument("--table", default=str(TABLE))
+    ap.add_argument("--out", default=str(OUT))
+    args = ap.parse_args()
+
+    rows = read_rows(Path(args.table))
+    h = build(rows)
+    text = render(rows, h)
+    out = Path(args.out)
+    if not out.exists() or out.read_text(encoding="utf-8") != text:
+        out.write_text(text, encoding="utf-8", newline="\n")
+    print("  cmd_hash.h: %d rows -> %d slots, %d buckets" % (len(rows), h["mask"] + 1, h["nb"]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -30,6 +30,7 @@ REQUIRED_FUNCTIONS = [
     # String/number utilities
     "_st_strlen",
     "_st_stricmp",
+    "_irc_hash",
     "_st_copy_n",
     "_fast_u8_to_str",
     # esxDOS
@@ -102,6 +103,8 @@ REQUIRED_VARIABLES = [
     "_rx_pos",
     "_rx_last_len",
     "_rx_overflow",
+    "_rx_stats",
+    "_frame_est",
     # Theme / print cursor
     "_theme_attrs",
     "_theme_raw",
@@ -147,11 +150,13 @@ REQUIRED_VARIABLES = [
     "_K_TZ",
     "_K_NOTIF",
     "_K_COUNTSYNC",
+    "_K_PASSIVE",
     "_S_ANYKEY",
     # Config variables (read-only from overlay)
     "_irc_nick",
     "_irc_server",
     "_irc_port",
+    "_irc_passive",
     "_irc_pass",
     "_nickserv_pass",
     "_nickserv_nick",
@@ -191,12 +196,21 @@ REQUIRED_VARIABLES = [
     "_sw_count",
     "_sw_dirty",
     "_autojoin_channels",
+    "_highlight_words",
     "_friend_nicks",
     "_friend_count",
+    "_friend_hash",
     "_ignore_list",
     "_ignore_count",
 ]
 
+# Present only in diagnostic build flavours (make stackprobe); exported
+# when the map has them, silently skipped otherwise.
+OPTIONAL_SYMBOLS = [
+    "_stack_stats",
+    "_stack_paint",
+]
+
 
 def parse_map(map_path):
     """Extract symbol addresses from .map file."""
@@ -228,6 +242,10 @@ def main():
         else:
             missing.append(name)
             print(f";; WARNING: {name} not found in .map!")
+    for name in OPTIONAL_SYMBOLS:
+        if name in symbols:
+            print(f"PUBLIC {name}")
+            print(f"DEFC {name} = ${symbols[name]:04X}")
 
     if missing:
         print(f"\n;; MISSING SYMBOLS: {', '.join(missing)}", file=sys.stderr)
@@ -0,0 +1,367 @@
+#!/usr/bin/env python3
+"""Seeded IRC load corpus for the worst-case bursts seen in production.
+
+Every scenario is a deterministic function of --seed and writes a timed
+SRX1 stream (see below) that tools/zxbench.py paces through its UART
+stand-in. The client nick is `benchzx`, matching the zxbench boot CFG, so
+numerics, highlights and JOIN echoes address the emulated client.
+
+Scenarios:
+    names      JOIN into a 2,000-user channel: 353 flood into h_numeric_353
+               and names_count_line(), then 366.
+    list       /list on a 20k-channel network: 321, 322 storm through
+               h_numeric_322_352, 323.
+    privmsg    PRIVMSG storm across 10 joined windows, with highlights,
+               CTCP ACTION and mIRC colour codes.
+    netsplit   Netsplit QUIT flood for users spread over the joined windows.
+    utf8       UTF-8 and raw Latin-1 heavy text for utf8_to_ascii.
+    longlines  Lines around RX_LINE_MAX (510) and far past it, for the
+               _rx_overflow discard path.
+    pagenames  Small JOIN, then a typed /names reply: a 2,000-user 353 burst
+               with channel PRIVMSGs mixed in. Bench it with zxbench --type
+               and --more-frames so the MORE prompt sits under the flood
+               and the critical ring discard runs with a 353 line held.
+    all        Every scenario above, back to back.
+
+SRX1 stream format (little endian):
+    "SRX1" magic, u8 tick length in milliseconds, then records of
+    { u16 delta ticks since previous record, u16 length, payload }.
+The generator uses 1 ms ticks. Records model TCP segments as the ESP
+forwards them; the UART stand-in still serialises every byte at line speed,
+so a record only gives the earliest time its bytes can start arriving.
+
+Usage:
+    python tools/irc_corpus.py names --seed 7 -o build/corpus/names.srx
+    python tools/irc_corpus.py all --out-dir build/corpus
+    python tools/irc_corpus.py list --raw -o list.irc
+    python tools/zxbench.py --capture build/corpus/pagenames.srx \
+        --type "0.5:/names #bigchan" --more-frames 100
+"""
+
+from __future__ import annotations
+
+import argparse
+import random
+import struct
+import sys
+from pathlib import Path
+from typing import Callable, Dict, Iterable, List, Tuple
+
+NICK = "benchzx"
+SERVER = "irc.bench.invalid"
+SRX_MAGIC = b"SRX1"
+TICK_MS = 1
+BAUD = 115_200
+MSS = 1460
+RX_LINE_MAX = 510
+
+# Server-side burst timing: a flood leaves the server as back-to-back MSS
+# segments; the ESP forwards each one a little after the previous one.
+SEGMENT_GAP_MS = (1, 4)
+
+SYLLABLES = ["ka", "zo", "mi", "ru", "te", "lo", "xa", "ne", "bi", "qu",
+             "sa", "do", "vi", "re", "po", "ly", "an", "or", "el", "im"]
+WORDS = ["spectrum", "z80", "basic", "tape", "loading", "border", "attr",
+         "beeper", "divmmc", "esxdos", "uart", "wifi", "speccy", "next",
+         "retro", "pixel", "sprite", "scroll", "ram", "rom", "game", "demo",
+         "hello", "anyone", "here", "today", "works", "fine", "thanks", "lol"]
+UTF8_WORDS = ["café", "mañana", "piñata", "über", "naïve",
+              "coração", "€10", "¿qué?", "¡sí!",
+              "straße", "ångström", "señor", "façade",
+              "—", "…", "“quoted”", "\U0001F600", "\U0001F44D",
+              "日本", "Привет"]
+LATIN1_WORDS = ["caf\xe9", "ma\xf1ana", "\xfcber", "se\xf1or", "\xbfqu\xe9?",
+                "cora\xe7\xe3o", "\xe5ngstr\xf6m", "\xa3\xa5\xa9"]
+
+Record = Tuple[int, bytes]  # (delta ms since previous record, payload)
+
+
+# =============================================================================
+# Stream builder
+# =============================================================================
+
+class Stream:
+    """Collects IRC lines into bursts, then cuts bursts into MSS segments."""
+
+    def __init__(self, rng: random.Random) -> None:
+        self.rng = rng
+        self.records: List[Record] = []
+        self._pending = bytearray()
+        self._gap_ms = 0
+
+    def line(self, text: str, encoding: str = "utf-8") -> None:
+        self._pending += text.encode(encoding, errors="replace") + b"\r\n"
+
+    def raw(self, data: bytes) -> None:
+        self._pending += data
+
+    def pause(self, ms: int) -> None:
+        """Flush the current burst; the next one starts `ms` later."""
+        self._flush()
+        self._gap_ms += ms
+
+    def _flush(self) -> None:
+        data = bytes(self._pending)
+        self._pending.clear()
+        for pos in range(0, len(data), MSS):
+            if pos:
+                self._gap_ms += self.rng.randint(*SEGMENT_GAP_MS)
+            self.records.append((self._gap_ms, data[pos:pos + MSS]))
+            self._gap_ms = 0
+
+    def finish(self) -> List[Record]:
+        self._flush()
+        return self.records
+
+
+def nick(rng: random.Random) -> str:
+    return "".join(rng.choice(SYLLABLES) for _ in range(rng.randint(2, 4))) \
+        + (str(rng.randint(0, 99)) if rng.random() < 0.3 else "")
+
+
+def unique_nicks(rng: random.Random, count: int) -> List[str]:
+    seen = {NICK}
+    out: List[str] = []
+    while len(out) < count:
+        n = nick(rng)
+        if n.lower() not in seen:
+            seen.add(n.lower())
+            out.append(n)
+    return out
+
+
+def prefix(n: str) -> str:
+    return f"{n}!{n[:8]}@{n}.users.bench.invalid"
+
+
+def sentence(rng: random.Random, lo: int = 3, hi: int = 14) -> str:
+    return " ".join(rng.choice(WORDS) for _ in range(rng.randint(lo, hi)))
+
+
+def join_channel(s: Stream, rng: random.Random, chan: str, users: List[str]) -> None:
+    """JOIN echo, topic, NAMES flood packed like ircd does (<= 510 bytes)."""
+    s.line(f":{prefix(NICK)} JOIN :{chan}")
+    s.line(f":{SERVER} 332 {NICK} {chan} :{sentence(rng)}")
+    s.line(f":{SERVER} 333 {NICK} {chan} {users[0] if users else NICK} 1700000000")
+    names_reply(s, rng, chan, users)
+
+
+def names_reply(s: Stream, rng: random.Random, chan: str, users: List[str],
+                chatter: int = 0) -> None:
+    """353 lines packed to RX_LINE_MAX, then 366. With chatter, up to that
+    many channel PRIVMSGs follow each 353 line, as a busy channel does."""
+    head = f":{SERVER} 353 {NICK} = {chan} :"
+    batch = [NICK]
+    for u in users:
+        mode = rng.choices(["", "@", "+"], weights=[85, 5, 10])[0]
+        entry = mode + u
+        if len(head) + len(" ".join(batch + [entry])) > RX_LINE_MAX:
+            s.line(head + " ".join(batch))
+            for _ in range(rng.randint(0, chatter) if chatter else 0):
+                s.line(f":{prefix(rng.choice(users))} PRIVMSG {chan} :{sentence(rng)}")
+            batch = []
+        batch.append(entry)
+    if batch:
+        s.line(head + " ".join(batch))
+    s.line(f":{SERVER} 366 {NICK} {chan} :End of /NAMES list.")
+
+
+# =============================================================================
+# Scenarios
+# =============================================================================
+
+def scen_names(s: Stream, rng: random.Random, a: argparse.Namespace) -> None:
+    join_channel(s, rng, "#bigchan", unique_nicks(rng, a.users))
+
+
+def scen_list(s: Stream, rng: random.Random, a: argparse.Namespace) -> None:
+    s.line(f":{SERVER} 321 {NICK} Channel :Users  Name")
+    for i in range(a.list_channels):
+        chan = "#" + "".join(rng.choice(SYLLABLES) for _ in range(rng.randint(1, 5))) + str(i)
+        users = max(1, int(rng.paretovariate(1.2)))
+        topic = f"[+{rng.choice(['nt', 'nts', 'ntk', 'Cnt'])}] " + sentence(rng, 0, 12)
+        s.line(f":{SERVER} 322 {NICK} {chan} {users} :{topic.rstrip()}")
+        if i % 200 == 199:
+            s.pause(rng.randint(5, 30))  # server send queue refill
+    s.line(f":{SERVER} 323 {NICK} :End of /LIST")
+
+
+def joined_channels(s: Stream, rng: random.Random, count: int,
+                    per_chan: int) -> Dict[str, List[str]]:
+    chans: Dict[str, List[str]] = {}
+    pool = unique_nicks(rng, per_chan * 2)
+    for i in range(count):
+        chan = f"#chan{i}"
+        chans[chan] = rng.sample(pool, per_chan)
+        join_channel(s, rng, chan, chans[chan])
+    s.pause(200)
+    return chans
+
+
+def scen_privmsg(s: Stream, rng: random.Random, a: argparse.Namespace) -> None:
+    chans = joined_channels(s, rng, a.windows, 40)
+    names = list(chans)
+    for i in range(a.messages):
+        chan = rng.choice(names)
+        who = rng.choice(chans[chan])
+        roll = rng.random()
+        if roll < 0.08:
+            text = f"{NICK}: {sentence(rng)}"
+        elif roll < 0.15:
+            text = f"\x01ACTION {sentence(rng, 2, 8)}\x01"
+        elif roll < 0.25:
+            text = f"\x03{rng.randint(0, 15)},{rng.randint(0, 15)}{sentence(rng)}\x0f \x02bold\x02 \x1funder\x1f"
+        else:
+            text = sentence(rng)
+        s.line(f":{prefix(who)} PRIVMSG {chan} :{text}")
+        if i % 25 == 24:
+            s.pause(rng.randint(0, 60))
+
+
+def scen_netsplit(s: Stream, rng: random.Random, a: argparse.Namespace) -> None:
+    chans = joined_channels(s, rng, min(a.windows, 3), 150)
+    users = sorted({u for members in chans.values() for u in members})
+    rng.shuffle(users)
+    reason = "hub.bench.invalid leaf.bench.invalid"
+    for u in users[:a.quits]:
+        s.line(f":{prefix(u)} QUIT :{reason}")
+    s.pause(2000)
+    for u in users[:a.quits // 2]:  # partial rejoin after the split heals
+        chan = rng.choice([c for c, m in chans.items() if u in m])
+        s.line(f":{prefix(u)} JOIN :{chan}")
+
+
+def scen_utf8(s: Stream, rng: random.Random, a: argparse.Namespace) -> None:
+    chans = joined_channels(s, rng, 2, 20)
+    names = list(chans)
+    for i in range(a.messages):
+        chan = rng.choice(names)
+        who = prefix(rng.choice(chans[chan]))
+        words = [rng.choice(WORDS) for _ in range(rng.randint(2, 10))]
+        if rng.random() < 0.25:
+            words = [rng.choice(LATIN1_WORDS) if rng.random() < 0.5 else w for w in words]
+            s.line(f":{who} PRIVMSG {chan} :{' '.join(words)}", "latin-1")
+        else:
+            words = [rng.choice(UTF8_WORDS) if rng.random() < 0.5 else w for w in words]
+            s.line(f":{who} PRIVMSG {chan} :{' '.join(words)}")
+        if i % 25 == 24:
+            s.pause(rng.randint(0, 60))
+
+
+def scen_longlines(s: Stream, rng: random.Random, a: argparse.Namespace) -> None:
+    chans = joined_channels(s, rng, 1, 10)
+    chan = next(iter(chans))
+    sizes = [500, 508, 509, 510, 511, 512, 600, 1024, 4096]
+    for i in range(a.messages):
+        size = sizes[i % len(sizes)]  # bytes before CRLF
+        head = f":{prefix(rng.choice(chans[chan]))} PRIVMSG {chan} :"
+        body = sentence(rng, 80, 200)
+        while len(head) + len(body) < size:
+            body += " " + sentence(rng)
+        s.line((head + body)[:size])
+        s.line(f":{prefix(rng.choice(chans[chan]))} PRIVMSG {chan} :after {size}")
+        if i % 9 == 8:
+            s.pause(rng.randint(0, 40))
+
+
+def scen_pagenames(s: Stream, rng: random.Random, a: argparse.Namespace) -> None:
+    users = unique_nicks(rng, a.users)
+    join_channel(s, rng, "#bigchan", users[:20])
+    s.pause(3000)  # zxbench --type "0.5:/names #bigchan" lands in here
+    names_reply(s, rng, "#bigchan", users, chatter=4)
+
+
+SCENARIOS: Dict[str, Callable[[Stream, random.Random, argparse.Namespace], None]] = {
+    "names": scen_names,
+    "list": scen_list,
+    "privmsg": scen_privmsg,
+    "netsplit": scen_netsplit,
+    "utf8": scen_utf8,
+    "longlines": scen_longlines,
+    "pagenames": scen_pagenames,
+}
+
+
+# =============================================================================
+# Output
+# =============================================================================
+
+def generate(name: str, args: argparse.Namespace) -> List[Record]:
+    # One RNG per scenario keeps each stream stable when others change.
+    rng = random.Random(f"{args.seed}:{name}")
+    s = Stream(rng)
+    SCENARIOS[name](s, rng, args)
+    return s.finish()
+
+
+def encode_srx(records: Iterable[Record]) -> bytes:
+    out = bytearray(SRX_MAGIC)
+    out.append(TICK_MS)
+    for delta, payload in records:
+        while delta > 0xFFFF:  # long pauses become empty records
+            out += struct.pack("<HH", 0xFFFF, 0)
+            delta -= 0xFFFF
+        for pos in range(0, len(payload), 0xFFFF):
+            part = payload[pos:pos + 0xFFFF]
+            out += struct.pack("<HH", delta if pos == 0 else 0, len(part)) + part
+    return bytes(out)
+
+
+def summary(name: str, records: List[Record]) -> str:
+    size = sum(len(p) for _, p in records)
+    lines = sum(p.count(b"\n") for _, p in records)
+    wire_s = size * 10 / BAUD
+    span_s = sum(d for d, _ in records) / 1000.0
+    return (f"{name:<10} {lines:>7} lines {size:>9} B  "
+            f"{wire_s:7.1f} s at {BAUD} baud, {span_s:6.1f} s of pauses")
+
+
+def build_arg_parser() -> argparse.ArgumentParser:
+    ap = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    ap.add_argument("scenario", choices=sorted(SCENARIOS) + ["all"])
+    ap.add_argument("--seed", type=int, default=1)
+    ap.add_argument("-o", "--output", type=Path, help="output file (single scenario)")
+    ap.add_argument("--out-dir", type=Path, help="write <scenario>.srx per scenario")
+    ap.add_argument("--raw", action="store_true",
+                    help="write the bare byte stream without SRX1 timing")
+    ap.add_argument("--users", type=int, default=2000, help="names: channel size")
+    ap.add_argument("--list-channels", type=int, default=20000, help="list: 322 count")
+    ap.add_argument("--windows", type=int, default=10, help="privmsg: joined channels")
+    ap.add_argument("--messages", type=int, default=1000, help="privmsg/utf8/longlines lines")
+    ap.add_argument("--quits", type=int, default=400, help="netsplit: QUIT count")
+    return ap
+
+
+def main() -> int:
+    args = build_arg_parser().parse_args()
+    names = sorted(SCENARIOS) if args.scenario == "all" else [args.scenario]
+    if args.out_dir is None and args.output is None:
+        print("irc_corpus: give -o FILE or --out-dir DIR", file=sys.stderr)
+        return 2
+    if args.output is not None and len(names) > 1:
+        # "all" into one file: scenarios back to back, 1 s apart.
+        records: List[Record] = []
+        for name in names:
+            part = generate(name, args)
+            if part:
+                records.append((1000, b""))
+                records += part
+            print(summary(name, part))
+        streams = {args.output: records}
+    else:
+        streams = {}
+        for name in names:
+            path = args.output or args.out_dir / f"{name}.{'irc' if args.raw else 'srx'}"
+            streams[path] = generate(name, args)
+            print(summary(name, streams[path]))
+    for path, records in streams.items():
+        path.parent.mkdir(parents=True, exist_ok=True)
+        if args.raw:
+            path.write_bytes(b"".join(p for _, p in records))
+        else:
+            path.write_bytes(encode_srx(records))
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,1142 @@
+#!/usr/bin/env python3
+"""Minimal cycle-counting Z80 core for SpecTalkZX host-side tools.
+
+Pure Python, no third-party dependencies. Implements the documented
+instruction set plus the undocumented pieces SDCC/z80asm output actually
+uses (IXH/IXL/IYH/IYL, SLL, DDCB register copies). T-states follow the
+uncontended 48K timings; memory contention is intentionally not modelled.
+
+The core knows nothing about the Spectrum: callers attach port handlers,
+PC traps and a timed event hook (see tools/zxbench.py).
+"""
+
+from __future__ import annotations
+
+from typing import Callable, Dict, List, Optional
+
+FLAG_C = 0x01
+FLAG_N = 0x02
+FLAG_PV = 0x04
+FLAG_X = 0x08
+FLAG_H = 0x10
+FLAG_Y = 0x20
+FLAG_Z = 0x40
+FLAG_S = 0x80
+
+SZ = [0] * 256
+SZP = [0] * 256
+for _v in range(256):
+    SZ[_v] = (_v & (FLAG_S | FLAG_X | FLAG_Y)) | (FLAG_Z if _v == 0 else 0)
+    SZP[_v] = SZ[_v] | (0 if bin(_v).count("1") & 1 else FLAG_PV)
+
+# Unprefixed base timings (branch-not-taken cost for conditional opcodes).
+CYC_MAIN = [
+    4, 10, 7, 6, 4, 4, 7, 4, 4, 11, 7, 6, 4, 4, 7, 4,
+    8, 10, 7, 6, 4, 4, 7, 4, 12, 11, 7, 6, 4, 4, 7, 4,
+    7, 10, 16, 6, 4, 4, 7, 4, 7, 11, 16, 6, 4, 4, 7, 4,
+    7, 10, 13, 6, 11, 11, 10, 4, 7, 11, 13, 6, 4, 4, 7, 4,
+    4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4,
+    4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4,
+    4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4,
+    7, 7, 7, 7, 7, 7, 4, 7, 4, 4, 4, 4, 4, 4, 7, 4,
+    4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4,
+    4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4,
+    4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4,
+    4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4,
+    5, 10, 10, 10, 10, 11, 7, 11, 5, 10, 10, 0, 10, 17, 7, 11,
+    5, 10, 10, 11, 10, 11, 7, 11, 5, 4, 10, 11, 10, 0, 7, 11,
+    5, 10, 10, 19, 10, 11, 7, 11, 5, 4, 10, 4, 10, 0, 7, 11,
+    5, 10, 10, 4, 10, 11, 7, 11, 5, 6, 10, 4, 10, 0, 7, 11,
+]
+
+# Opcodes whose DD/FD form addresses (IX+d): +8 T over 4+base, except LD (IX+d),n.
+_INDEXED_MEM = {0x34, 0x35, 0x36, 0x46, 0x4E, 0x56, 0x5E, 0x66, 0x6E, 0x7E,
+                0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x77,
+                0x86, 0x8E, 0x96, 0x9E, 0xA6, 0xAE, 0xB6, 0xBE}
+
+EventHook = Callable[["Z80"], None]
+
+
+class Z80:
+    """Z80 CPU with a flat 64 KB address space.
+
+    Writes below ``rom_top`` are ignored. ``traps`` maps PC values to
+    callables invoked before the opcode fetch; a trap returning True means
+    it already changed CPU state and the fetch is skipped for this step.
+    ``next_event``/``on_event`` give the host one compare per instruction
+    for interrupts, sampling and other timed work.
+    """
+
+    def __init__(self) -> None:
+        self.mem = bytearray(65536)
+        self.rom_top = 0
+        self.a = self.f = self.b = self.c = self.d = self.e = self.h = self.l = 0
+        self.a_ = self.f_ = self.b_ = self.c_ = self.d_ = self.e_ = self.h_ = self.l_ = 0
+        self.ix = self.iy = 0xFFFF
+        self.sp = 0xFFFF
+        self.pc = 0
+        self.i = self.r = 0
+        self.iff1 = self.iff2 = 0
+        self.im = 0
+        self.halted = False
+        self.ei_delay = False
+        self.t = 0
+        self.next_event = 1 << 62
+        self.on_event: Optional[EventHook] = None
+        self.traps: Dict[int, Callable[["Z80"], bool]] = {}
+        self.port_in: Callable[[int], int] = lambda port: 0xFF
+        self.port_out: Callable[[int, int], None] = lambda port, value: None
+        self.int_bus = 0xFF
+        self._ops = _build_table(None)
+        self._ops_dd = _build_table("ix")
+        self._ops_fd = _build_table("iy")
+        self._ops_cb = _build_cb()
+        self._ops_ed = _build_ed()
+
+    # -- register pairs -------------------------------------------------
+    @property
+    def bc(self) -> int:
+        return (self.b << 8) | self.c
+
+    @bc.setter
+    def bc(self, v: int) -> None:
+        self.b = (v >> 8) & 0xFF
+        self.c = v & 0xFF
+
+    @property
+    def de(self) -> int:
+        return (self.d << 8) | self.e
+
+    @de.setter
+    def de(self, v: int) -> None:
+        self.d = (v >> 8) & 0xFF
+        self.e = v & 0xFF
+
+    @property
+    def hl(self) -> int:
+        return (self.h << 8) | self.l
+
+    @hl.setter
+    def hl(self, v: int) -> None:
+        self.h = (v >> 8) & 0xFF
+        self.l = v & 0xFF
+
+    @property
+    def af(self) -> int:
+        return (self.a << 8) | self.f
+
+    @af.setter
+    def af(self, v: int) -> None:
+        self.a = (v >> 8) & 0xFF
+        self.f = v & 0xFF
+
+    # -- memory -----------------------------------------------------------
+    def rb(self, addr: int) -> int:
+        return self.mem[addr & 0xFFFF]
+
+    def wb(self, addr: int, v: int) -> None:
+        addr &= 0xFFFF
+        if addr >= self.rom_top:
+            self.mem[addr] = v & 0xFF
+
+    def rw(self, addr: int) -> int:
+        mem = self.mem
+        return mem[addr & 0xFFFF] | (mem[(addr + 1) & 0xFFFF] << 8)
+
+    def ww(self, addr: int, v: int) -> None:
+        self.wb(addr, v)
+        self.wb(addr + 1, v >> 8)
+
+    def fetch(self) -> int:
+        v = self.mem[self.pc]
+        self.pc = (self.pc + 1) & 0xFFFF
+        return v
+
+    def fetch16(self) -> int:
+        lo = self.fetch()
+        return lo | (self.fetch() << 8)
+
+    def fetch_disp(self) -> int:
+        d = self.fetch()
+        return d - 256 if d & 0x80 else d
+
+    def push(self, v: int) -> None:
+        self.sp = (self.sp - 2) & 0xFFFF
+        self.ww(self.sp, v)
+
+    def pop(self) -> int:
+        v = self.rw(self.sp)
+        self.sp = (self.sp + 2) & 0xFFFF
+        return v
+
+    # -- execution --------------------------------------------------------
+    def interrupt(self) -> bool:
+        """Raise the maskable interrupt line; returns True when accepted."""
+        if not self.iff1 or self.ei_delay:
+            return False
+        if self.halted:
+            self.halted = False
+            self.pc = (self.pc + 1) & 0xFFFF
+        self.iff1 = self.iff2 = 0
+        self.r = (self.r & 0x80) | ((self.r + 1) & 0x7F)
+        self.push(self.pc)
+        if self.im == 2:
+            self.pc = self.rw((self.i << 8) | self.int_bus)
+            self.t += 19
+        else:
+            self.pc = 0x0038
+            self.t += 13
+        return True
+
+    def step(self) -> None:
+        if self.t >= self.next_event and self.on_event is not None:
+            self.on_event(self)
+        pc = self.pc
+        trap = self.traps.get(pc)
+        if trap is not None and trap(self):
+            return
+        self.ei_delay = False
+        op = self.mem[pc]
+        self.pc = (pc + 1) & 0xFFFF
+        self.r = (self.r & 0x80) | ((self.r + 1) & 0x7F)
+        self.t += self._ops[op](self)
+
+    def run_until(self, t_limit: int) -> None:
+        """Run until ``t`` reaches ``t_limit`` (inlined copy of step())."""
+        mem = self.mem
+        ops = self._ops
+        traps = self.traps
+        while self.t < t_limit:
+            if self.t >= self.next_event and self.on_event is not None:
+                self.on_event(self)
+                continue
+            pc = self.pc
+            if pc in traps and traps[pc](self):
+                continue
+            self.ei_delay = False
+            self.pc = (pc + 1) & 0xFFFF
+            self.r = (self.r & 0x80) | ((self.r + 1) & 0x7F)
+            self.t += ops[mem[pc]](self)
+
+    # -- prefixes (called from the tables) --------------------------------
+    def exec_cb(self) -> int:
+        op = self.fetch()
+        self.r = (self.r & 0x80) | ((self.r + 1) & 0x7F)
+        return self._ops_cb[op](self)
+
+    def exec_ed(self) -> int:
+        op = self.fetch()
+        self.r = (self.r & 0x80) | ((self.r + 1) & 0x7F)
+        return self._ops_ed[op](self)
+
+    def exec_index(self, table: List[Callable[["Z80"], int]]) -> int:
+        op = self.mem[self.pc]
+        if op in (0xDD, 0xFD, 0xED):
+            return 4  # prefix acts as a NOP; the next one is decoded normally
+        self.pc = (self.pc + 1) & 0xFFFF
+        self.r = (self.r & 0x80) | ((self.r + 1) & 0x7F)
+        return table[op](self)
+
+
+# =============================================================================
+# ALU helpers
+# =============================================================================
+
+def _add8(cpu: Z80, v: int, carry: int) -> None:
+    a = cpu.a
+    res = a + v + carry
+    r8 = res & 0xFF
+    cpu.f = (SZ[r8] | (res >> 8) | ((a ^ v ^ r8) & FLAG_H)
+             | ((((a ^ ~v) & (a ^ r8)) >> 5) & FLAG_PV))
+    cpu.a = r8
+
+
+def _sub8(cpu: Z80, v: int, carry: int, store: bool = True) -> None:
+    a = cpu.a
+    res = a - v - carry
+    r8 = res & 0xFF
+    f = (SZ[r8] | FLAG_N | (1 if res < 0 else 0) | ((a ^ v ^ r8) & FLAG_H)
+         | ((((a ^ v) & (a ^ r8)) >> 5) & FLAG_PV))
+    if store:
+        cpu.a = r8
+        cpu.f = f
+    else:
+        cpu.f = (f & ~(FLAG_X | FLAG_Y)) | (v & (FLAG_X | FLAG_Y))
+
+
+def _alu(cpu: Z80, idx: int, v: int) -> None:
+    if idx == 0:
+        _add8(cpu, v, 0)
+    elif idx == 1:
+        _add8(cpu, v, cpu.f & FLAG_C)
+    elif idx == 2:
+        _sub8(cpu, v, 0)
+    elif idx == 3:
+        _sub8(cpu, v, cpu.f & FLAG_C)
+    elif idx == 4:
+        cpu.a &= v
+        cpu.f = SZP[cpu.a] | FLAG_H
+    elif idx == 5:
+        cpu.a ^= v
+        cpu.f = SZP[cpu.a]
+    elif idx == 6:
+        cpu.a |= v
+        cpu.f = SZP[cpu.a]
+    else:
+        _sub8(cpu, v, 0, store=False)
+
+
+def _inc8(cpu: Z80, v: int) -> int:
+    r = (v + 1) & 0xFF
+    cpu.f = ((cpu.f & FLAG_C) | SZ[r] | (FLAG_H if (r & 0x0F) == 0 else 0)
+             | (FLAG_PV if r == 0x80 else 0))
+    return r
+
+
+def _dec8(cpu: Z80, v: int) -> int:
+    r = (v - 1) & 0xFF
+    cpu.f = ((cpu.f & FLAG_C) | FLAG_N | SZ[r] | (FLAG_H if (r & 0x0F) == 0x0F else 0)
+             | (FLAG_PV if r == 0x7F else 0))
+    return r
+
+
+def _add16(cpu: Z80, a: int, b: int) -> int:
+    res = a + b
+    cpu.f = ((cpu.f & (FLAG_S | FLAG_Z | FLAG_PV)) | ((res >> 16) & FLAG_C)
+             | (((a ^ b ^ res) >> 8) & FLAG_H) | ((res >> 8) & (FLAG_X | FLAG_Y)))
+    return res & 0xFFFF
+
+
+def _adc16(cpu: Z80, b: int) -> None:
+    a = cpu.hl
+    res = a + b + (cpu.f & FLAG_C)
+    r16 = res & 0xFFFF
+    cpu.f = (((r16 >> 8) & (FLAG_S | FLAG_X | FLAG_Y)) | (FLAG_Z if r16 == 0 else 0)
+             | ((res >> 16) & FLAG_C) | (((a ^ b ^ r16) >> 8) & FLAG_H)
+             | ((((a ^ ~b) & (a ^ r16)) >> 13) & FLAG_PV))
+    cpu.hl = r16
+
+
+def _sbc16(cpu: Z80, b: int) -> None:
+    a = cpu.hl
+    res = a - b - (cpu.f & FLAG_C)
+    r16 = res & 0xFFFF
+    cpu.f = (((r16 >> 8) & (FLAG_S | FLAG_X | FLAG_Y)) | (FLAG_Z if r16 == 0 else 0)
+             | (FLAG_C if res < 0 else 0) | FLAG_N | (((a ^ b ^ r16) >> 8) & FLAG_H)
+             | ((((a ^ b) & (a ^ r16)) >> 13) & FLAG_PV))
+    cpu.hl = r16
+
+
+def _rot(cpu: Z80, kind: int, v: int) -> int:
+    """CB rotate/shift group: RLC RRC RL RR SLA SRA SLL SRL."""
+    c = cpu.f & FLAG_C
+    if kind == 0:
+        c = v >> 7
+        v = ((v << 1) | c) & 0xFF
+    elif kind == 1:
+        c = v & 1
+        v = (v >> 1) | (c << 7)
+    elif kind == 2:
+        nc = v >> 7
+        v = ((v << 1) | c) & 0xFF
+        c = nc
+    elif kind == 3:
+        nc = v & 1
+        v = (v >> 1) | (c << 7)
+        c = nc
+    elif kind == 4:
+        c = v >> 7
+        v = (v << 1) & 0xFF
+    elif kind == 5:
+        c = v & 1
+        v = (v >> 1) | (v & 0x80)
+    elif kind == 6:
+        c = v >> 7
+        v = ((v << 1) | 1) & 0xFF
+    else:
+        c = v & 1
+        v >>= 1
+    cpu.f = SZP[v] | c
+    return v
+
+
+def _cond(cpu: Z80, cc: int) -> bool:
+    f = cpu.f
+    if cc == 0:
+        return not f & FLAG_Z
+    if cc == 1:
+        return bool(f & FLAG_Z)
+    if cc == 2:
+        return not f & FLAG_C
+    if cc == 3:
+        return bool(f & FLAG_C)
+    if cc == 4:
+        return not f & FLAG_PV
+    if cc == 5:
+        return bool(f & FLAG_PV)
+    if cc == 6:
+        return not f & FLAG_S
+    return bool(f & FLAG_S)
+
+
+# =============================================================================
+# Table builders
+# =============================================================================
+
+_R8 = ("b", "c", "d", "e", "h", "l", None, "a")
+
+
+def _reg_names(xy: Optional[str]) -> tuple:
+    if xy is None:
+        return _R8
+    return ("b", "c", "d", "e", xy + "h", xy + "l", None, "a")
+
+
+def _get8(cpu: Z80, name: str) -> int:
+    if name == "ixh":
+        return cpu.ix >> 8
+    if name == "ixl":
+        return cpu.ix & 0xFF
+    if name == "iyh":
+        return cpu.iy >> 8
+    if name == "iyl":
+        return cpu.iy & 0xFF
+    return getattr(cpu, name)
+
+
+def _set8(cpu: Z80, name: str, v: int) -> None:
+    v &= 0xFF
+    if name == "ixh":
+        cpu.ix = (cpu.ix & 0x00FF) | (v << 8)
+    elif name == "ixl":
+        cpu.ix = (cpu.ix & 0xFF00) | v
+    elif name == "iyh":
+        cpu.iy = (cpu.iy & 0x00FF) | (v << 8)
+    elif name == "iyl":
+        cpu.iy = (cpu.iy & 0xFF00) | v
+    else:
+        setattr(cpu, name, v)
+
+
+def _hl_get(xy: Optional[str]) -> Callable[[Z80], int]:
+    if xy == "ix":
+        return lambda cpu: cpu.ix
+    if xy == "iy":
+        return lambda cpu: cpu.iy
+    return lambda cpu: (cpu.h << 8) | cpu.l
+
+
+def _hl_set(xy: Optional[str]) -> Callable[[Z80, int], None]:
+    if xy == "ix":
+        def s(cpu: Z80, v: int) -> None:
+            cpu.ix = v & 0xFFFF
+    elif xy == "iy":
+        def s(cpu: Z80, v: int) -> None:
+            cpu.iy = v & 0xFFFF
+    else:
+        def s(cpu: Z80, v: int) -> None:
+            cpu.h = (v >> 8) & 0xFF
+            cpu.l = v & 0xFF
+    return s
+
+
+def _mem_addr(xy: Optional[str]) -> Callable[[Z80], int]:
+    """(HL) or (IX+d)/(IY+d); the displacement is fetched on call."""
+    if xy == "ix":
+        return lambda cpu: (cpu.ix + cpu.fetch_disp()) & 0xFFFF
+    if xy == "iy":
+        return lambda cpu: (cpu.iy + cpu.fetch_disp()) & 0xFFFF
+    return lambda cpu: (cpu.h << 8) | cpu.l
+
+
+def _rp_get(idx: int, xy: Optional[str], af: bool = False) -> Callable[[Z80], int]:
+    if idx == 0:
+        return lambda cpu: (cpu.b << 8) | cpu.c
+    if idx == 1:
+        return lambda cpu: (cpu.d << 8) | cpu.e
+    if idx == 2:
+        return _hl_get(xy)
+    if af:
+        return lambda cpu: (cpu.a << 8) | cpu.f
+    return lambda cpu: cpu.sp
+
+
+def _rp_set(idx: int, xy: Optional[str], af: bool = False) -> Callable[[Z80, int], None]:
+    if idx == 0:
+        def s(cpu: Z80, v: int) -> None:
+            cpu.b = (v >> 8) & 0xFF
+            cpu.c = v & 0xFF
+        return s
+    if idx == 1:
+        def s(cpu: Z80, v: int) -> None:
+            cpu.d = (v >> 8) & 0xFF
+            cpu.e = v & 0xFF
+        return s
+    if idx == 2:
+        return _hl_set(xy)
+    if af:
+        def s(cpu: Z80, v: int) -> None:
+            cpu.a = (v >> 8) & 0xFF
+            cpu.f = v & 0xFF
+        return s
+
+    def s(cpu: Z80, v: int) -> None:
+        cpu.sp = v & 0xFFFF
+    return s
+
+
+def _build_table(xy: Optional[str]) -> List[Callable[[Z80], int]]:
+    table: List[Callable[[Z80], int]] = [None] * 256  # type: ignore[list-item]
+    names = _reg_names(xy)
+    extra = 0 if xy is None else 4
+    hl_get = _hl_get(xy)
+    hl_set = _hl_set(xy)
+    maddr = _mem_addr(xy)
+
+    for op in range(256):
+        cyc = CYC_MAIN[op] + extra
+        if xy is not None and op in _INDEXED_MEM:
+            cyc += 5 if op == 0x36 else 8
+        x, y, z = op >> 6, (op >> 3) & 7, op & 7
+        p, q = y >> 1, y & 1
+        table[op] = _make_op(op, x, y, z, p, q, cyc, xy, names, hl_get, hl_set, maddr)
+    return table
+
+
+def _make_op(op, x, y, z, p, q, cyc, xy, names, hl_get, hl_set, maddr):  # noqa: C901
+    # ---- x == 1: LD r,r' / HALT ---------------------------------------
+    if x == 1:
+        if op == 0x76:
+            def halt(cpu: Z80) -> int:
+                cpu.halted = True
+                cpu.pc = (cpu.pc - 1) & 0xFFFF
+                if cpu.iff1 and cpu.next_event > cpu.t + 4:
+                    return cpu.next_event - cpu.t  # idle straight to the next host event
+                return 4
+            return halt
+        if y == 6:
+            src = _R8[z]
+
+            def ld_m_r(cpu: Z80) -> int:
+                cpu.wb(maddr(cpu), getattr(cpu, src))
+                return cyc
+            return ld_m_r
+        if z == 6:
+            dst = _R8[y]
+
+            def ld_r_m(cpu: Z80) -> int:
+                setattr(cpu, dst, cpu.mem[maddr(cpu)])
+                return cyc
+            return ld_r_m
+        dst, src = names[y], names[z]
+        if dst in _R8 and src in _R8:
+            def ld_r_r(cpu: Z80) -> int:
+                setattr(cpu, dst, getattr(cpu, src))
+                return cyc
+            return ld_r_r
+
+        def ld_r_r_x(cpu: Z80) -> int:
+            _set8(cpu, dst, _get8(cpu, src))
+            return cyc
+        return ld_r_r_x
+
+    # ---- x == 2: ALU A,r ------------------------------------------------
+    if x == 2:
+        if z == 6:
+            def alu_m(cpu: Z80) -> int:
+                _alu(cpu, y, cpu.mem[maddr(cpu)])
+                return cyc
+            return alu_m
+        src = names[z]
+
+        def alu_r(cpu: Z80) -> int:
+            _alu(cpu, y, _get8(cpu, src))
+            return cyc
+        return alu_r
+
+    # ---- x == 0 ---------------------------------------------------------
+    if x == 0:
+        if z == 0:
+            if y == 0:
+                return lambda cpu: cyc
+            if y == 1:
+                def ex_af(cpu: Z80) -> int:
+                    cpu.a, cpu.a_ = cpu.a_, cpu.a
+                    cpu.f, cpu.f_ = cpu.f_, cpu.f
+                    return cyc
+                return ex_af
+            if y == 2:
+                def djnz(cpu: Z80) -> int:
+                    d = cpu.fetch_disp()
+                    cpu.b = (cpu.b - 1) & 0xFF
+                    if cpu.b:
+                        cpu.pc = (cpu.pc + d) & 0xFFFF
+                        return cyc + 5
+                    return cyc
+                return djnz
+            if y == 3:
+                def jr(cpu: Z80) -> int:
+                    d = cpu.fetch_disp()
+                    cpu.pc = (cpu.pc + d) & 0xFFFF
+                    return cyc
+                return jr
+            cc = y - 4
+
+            def jr_cc(cpu: Z80) -> int:
+                d = cpu.fetch_disp()
+                if _cond(cpu, cc):
+                    cpu.pc = (cpu.pc + d) & 0xFFFF
+                    return cyc + 5
+                return cyc
+            return jr_cc
+        if z == 1:
+            rp_get = _rp_get(p, xy)
+            rp_set = _rp_set(p, xy)
+            if q == 0:
+                def ld_rp_nn(cpu: Z80) -> int:
+                    rp_set(cpu, cpu.fetch16())
+                    return cyc
+                return ld_rp_nn
+
+            def add_hl_rp(cpu: Z80) -> int:
+                hl_set(cpu, _add16(cpu, hl_get(cpu), rp_get(cpu)))
+                return cyc
+            return add_hl_rp
+        if z == 2:
+            if op == 0x02:
+                def ld_bc_a(cpu: Z80) -> int:
+                    cpu.wb(cpu.bc, cpu.a)
+                    return cyc
+                return ld_bc_a
+            if op == 0x12:
+                def ld_de_a(cpu: Z80) -> int:
+                    cpu.wb(cpu.de, cpu.a)
+                    return cyc
+                return ld_de_a
+            if op == 0x22:
+                def ld_nn_hl(cpu: Z80) -> int:
+                    cpu.ww(cpu.fetch16(), hl_get(cpu))
+                    return cyc
+                return ld_nn_hl
+            if op == 0x32:
+                def ld_nn_a(cpu: Z80) -> int:
+                    cpu.wb(cpu.fetch16(), cpu.a)
+                    return cyc
+                return ld_nn_a
+            if op == 0x0A:
+                def ld_a_bc(cpu: Z80) -> int:
+                    cpu.a = cpu.mem[cpu.bc]
+                    return cyc
+                return ld_a_bc
+            if op == 0x1A:
+                def ld_a_de(cpu: Z80) -> int:
+                    cpu.a = cpu.mem[cpu.de]
+                    return cyc
+                return ld_a_de
+            if op == 0x2A:
+                def ld_hl_nn(cpu: Z80) -> int:
+                    hl_set(cpu, cpu.rw(cpu.fetch16()))
+                    return cyc
+                return ld_hl_nn
+
+            def ld_a_nn(cpu: Z80) -> int:
+                cpu.a = cpu.mem[cpu.fetch16()]
+                return cyc
+            return ld_a_nn
+        if z == 3:
+            rp_get = _rp_get(p, xy)
+            rp_set = _rp_set(p, xy)
+            delta = 1 if q == 0 else -1
+
+            def incdec_rp(cpu: Z80) -> int:
+                rp_set(cpu, (rp_get(cpu) + delta) & 0xFFFF)
+                return cyc
+            return incdec_rp
+        if z in (4, 5):
+            fn = _inc8 if z == 4 else _dec8
+            if y == 6:
+                def incdec_m(cpu: Z80) -> int:
+                    addr = maddr(cpu)
+                    cpu.wb(addr, fn(cpu, cpu.mem[addr]))
+                    return cyc
+                return incdec_m
+            name = names[y]
+
+            def incdec_r(cpu: Z80) -> int:
+                _set8(cpu, name, fn(cpu, _get8(cpu, name)))
+                return cyc
+            return incdec_r
+        if z == 6:
+            if y == 6:
+                def ld_m_n(cpu: Z80) -> int:
+                    addr = maddr(cpu)
+                    cpu.wb(addr, cpu.fetch())
+                    return cyc
+                return ld_m_n
+            name = names[y]
+
+            def ld_r_n(cpu: Z80) -> int:
+                _set8(cpu, name, cpu.fetch())
+                return cyc
+            return ld_r_n
+        # z == 7: accumulator/flag ops
+        if y == 0:
+            def rlca(cpu: Z80) -> int:
+                c = cpu.a >> 7
+                cpu.a = ((cpu.a << 1) | c) & 0xFF
+                cpu.f = (cpu.f & (FLAG_S | FLAG_Z | FLAG_PV)) | (cpu.a & (FLAG_X | FLAG_Y)) | c
+                return cyc
+            return rlca
+        if y == 1:
+            def rrca(cpu: Z80) -> int:
+                c = cpu.a & 1
+                cpu.a = (cpu.a >> 1) | (c << 7)
+                cpu.f = (cpu.f & (FLAG_S | FLAG_Z | FLAG_PV)) | (cpu.a & (FLAG_X | FLAG_Y)) | c
+                return cyc
+            return rrca
+        if y == 2:
+            def rla(cpu: Z80) -> int:
+                c = cpu.a >> 7
+                cpu.a = ((cpu.a << 1) | (cpu.f & FLAG_C)) & 0xFF
+                cpu.f = (cpu.f & (FLAG_S | FLAG_Z | FLAG_PV)) | (cpu.a & (FLAG_X | FLAG_Y)) | c
+                return cyc
+            return rla
+        if y == 3:
+            def rra(cpu: Z80) -> int:
+                c = cpu.a & 1
+                cpu.a = (cpu.a >> 1) | ((cpu.f & FLAG_C) << 7)
+                cpu.f = (cpu.f & (FLAG_S | FLAG_Z | FLAG_PV)) | (cpu.a & (FLAG_X | FLAG_Y)) | c
+                return cyc
+            return rra
+        if y == 4:
+            def daa(cpu: Z80) -> int:
+                a, f = cpu.a, cpu.f
+                corr = 0
+                carry = f & FLAG_C
+                if (f & FLAG_H) or (a & 0x0F) > 9:
+                    corr |= 0x06
+                if carry or a > 0x99:
+                    corr |= 0x60
+                    carry = FLAG_C
+                if f & FLAG_N:
+                    res = (a - corr) & 0xFF
+                    h = FLAG_H if (f & FLAG_H) and (a & 0x0F) < 6 else 0
+                else:
+                    res = (a + corr) & 0xFF
+                    h = FLAG_H if (a & 0x0F) > 9 else 0
+                cpu.a = res
+                cpu.f = SZP[res] | h | (f & FLAG_N) | carry
+                return cyc
+            return daa
+        if y == 5:
+            def cpl(cpu: Z80) -> int:
+                cpu.a ^= 0xFF
+                cpu.f = (cpu.f & (FLAG_S | FLAG_Z | FLAG_PV | FLAG_C)) | FLAG_H | FLAG_N | (cpu.a & (FLAG_X | FLAG_Y))
+                return cyc
+            return cpl
+        if y == 6:
+            def scf(cpu: Z80) -> int:
+                cpu.f = (cpu.f & (FLAG_S | FLAG_Z | FLAG_PV)) | (cpu.a & (FLAG_X | FLAG_Y)) | FLAG_C
+                return cyc
+            return scf
+
+        def ccf(cpu: Z80) -> int:
+            c = cpu.f & FLAG_C
+            cpu.f = ((cpu.f & (FLAG_S | FLAG_Z | FLAG_PV)) | (cpu.a & (FLAG_X | FLAG_Y))
+                     | (FLAG_H if c else 0) | (c ^ FLAG_C))
+            return cyc
+        return ccf
+
+    # ---- x == 3 ---------------------------------------------------------
+    if z == 0:
+        cc = y
+
+        def ret_cc(cpu: Z80) -> int:
+            if _cond(cpu, cc):
+                cpu.pc = cpu.pop()
+                return cyc + 6
+            return cyc
+        return ret_cc
+    if z == 1:
+        if q == 0:
+            rp_set = _rp_set(p, xy, af=True)
+
+            def pop_rp(cpu: Z80) -> int:
+                rp_set(cpu, cpu.pop())
+                return cyc
+            return pop_rp
+        if p == 0:
+            def ret(cpu: Z80) -> int:
+                cpu.pc = cpu.pop()
+                return cyc
+            return ret
+        if p == 1:
+            def exx(cpu: Z80) -> int:
+                cpu.b, cpu.b_ = cpu.b_, cpu.b
+                cpu.c, cpu.c_ = cpu.c_, cpu.c
+                cpu.d, cpu.d_ = cpu.d_, cpu.d
+                cpu.e, cpu.e_ = cpu.e_, cpu.e
+                cpu.h, cpu.h_ = cpu.h_, cpu.h
+                cpu.l, cpu.l_ = cpu.l_, cpu.l
+                return cyc
+            return exx
+        if p == 2:
+            def jp_hl(cpu: Z80) -> int:
+                cpu.pc = hl_get(cpu)
+                return cyc
+            return jp_hl
+
+        def ld_sp_hl(cpu: Z80) -> int:
+            cpu.sp = hl_get(cpu)
+            return cyc
+        return ld_sp_hl
+    if z == 2:
+        cc = y
+
+        def jp_cc(cpu: Z80) -> int:
+            addr = cpu.fetch16()
+            if _cond(cpu, cc):
+                cpu.pc = addr
+            return cyc
+        return jp_cc
+    if z == 3:
+        if y == 0:
+            def jp(cpu: Z80) -> int:
+                cpu.pc = cpu.fetch16()
+                return cyc
+            return jp
+        if y == 1:
+            if xy is None:
+                return lambda cpu: cpu.exec_cb()
+            return _make_ddcb(xy)
+        if y == 2:
+            def out_n_a(cpu: Z80) -> int:
+                n = cpu.fetch()
+                cpu.port_out((cpu.a << 8) | n, cpu.a)
+                return cyc
+            return out_n_a
+        if y == 3:
+            def in_a_n(cpu: Z80) -> int:
+                n = cpu.fetch()
+                cpu.a = cpu.port_in((cpu.a << 8) | n) & 0xFF
+                return cyc
+            return in_a_n
+        if y == 4:
+            def ex_sp_hl(cpu: Z80) -> int:
+                v = cpu.rw(cpu.sp)
+                cpu.ww(cpu.sp, hl_get(cpu))
+                hl_set(cpu, v)
+                return cyc
+            return ex_sp_hl
+        if y == 5:
+            def ex_de_hl(cpu: Z80) -> int:
+                cpu.d, cpu.h = cpu.h, cpu.d
+                cpu.e, cpu.l = cpu.l, cpu.e
+                return cyc
+            return ex_de_hl
+        if y == 6:
+            def di(cpu: Z80) -> int:
+                cpu.iff1 = cpu.iff2 = 0
+                return cyc
+            return di
+
+        def ei(cpu: Z80) -> int:
+            cpu.iff1 = cpu.iff2 = 1
+            cpu.ei_delay = True
+            return cyc
+        return ei
+    if z == 4:
+        cc = y
+
+        def call_cc(cpu: Z80) -> int:
+            addr = cpu.fetch16()
+            if _cond(cpu, cc):
+                cpu.push(cpu.pc)
+                cpu.pc = addr
+                return cyc + 7
+            return cyc
+        return call_cc
+    if z == 5:
+        if q == 0:
+            rp_get = _rp_get(p, xy, af=True)
+
+            def push_rp(cpu: Z80) -> int:
+                cpu.push(rp_get(cpu))
+                return cyc
+            return push_rp
+        if p == 0:
+            def call(cpu: Z80) -> int:
+                addr = cpu.fetch16()
+                cpu.push(cpu.pc)
+                cpu.pc = addr
+                return cyc
+            return call
+        if p == 1:
+            return lambda cpu: cpu.exec_index(cpu._ops_dd)
+        if p == 2:
+            return lambda cpu: cpu.exec_ed()
+        return lambda cpu: cpu.exec_index(cpu._ops_fd)
+    if z == 6:
+        def alu_n(cpu: Z80) -> int:
+            _alu(cpu, y, cpu.fetch())
+            return cyc
+        return alu_n
+    vec = y * 8
+
+    def rst(cpu: Z80) -> int:
+        cpu.push(cpu.pc)
+        cpu.pc = vec
+        return cyc
+    return rst
+
+
+def _make_ddcb(xy: str) -> Callable[[Z80], int]:
+    def ddcb(cpu: Z80) -> int:
+        base = cpu.ix if xy == "ix" else cpu.iy
+        addr = (base + cpu.fetch_disp()) & 0xFFFF
+        op = cpu.fetch()
+        x, y, z = op >> 6, (op >> 3) & 7, op & 7
+        v = cpu.mem[addr]
+        if x == 1:
+            res = v & (1 << y)
+            cpu.f = ((cpu.f & FLAG_C) | FLAG_H | (SZP[res] & ~(FLAG_X | FLAG_Y))
+                     | ((addr >> 8) & (FLAG_X | FLAG_Y)))
+            return 20
+        if x == 0:
+            v = _rot(cpu, y, v)
+        elif x == 2:
+            v &= ~(1 << y) & 0xFF
+        else:
+            v |= 1 << y
+        cpu.wb(addr, v)
+        if z != 6:
+            setattr(cpu, _R8[z], v)
+        return 23
+    return ddcb
+
+
+def _build_cb() -> List[Callable[[Z80], int]]:
+    table: List[Callable[[Z80], int]] = []
+    for op in range(256):
+        x, y, z = op >> 6, (op >> 3) & 7, op & 7
+        table.append(_make_cb(x, y, z))
+    return table
+
+
+def _make_cb(x: int, y: int, z: int) -> Callable[[Z80], int]:
+    if z == 6:
+        if x == 1:
+            def bit_m(cpu: Z80) -> int:
+                res = cpu.mem[cpu.hl] & (1 << y)
+                cpu.f = (cpu.f & FLAG_C) | FLAG_H | (SZP[res] & ~(FLAG_X | FLAG_Y))
+                return 12
+            return bit_m
+
+        def cb_m(cpu: Z80) -> int:
+            addr = cpu.hl
+            v = cpu.mem[addr]
+            if x == 0:
+                v = _rot(cpu, y, v)
+            elif x == 2:
+                v &= ~(1 << y) & 0xFF
+            else:
+                v |= 1 << y
+            cpu.wb(addr, v)
+            return 15
+        return cb_m
+    name = _R8[z]
+    if x == 1:
+        def bit_r(cpu: Z80) -> int:
+            v = getattr(cpu, name)
+            res = v & (1 << y)
+            cpu.f = (cpu.f & FLAG_C) | FLAG_H | (SZP[res] & ~(FLAG_X | FLAG_Y)) | (v & (FLAG_X | FLAG_Y))
+            return 8
+        return bit_r
+
+    def cb_r(cpu: Z80) -> int:
+        v = getattr(cpu, name)
+        if x == 0:
+            v = _rot(cpu, y, v)
+        elif x == 2:
+            v &= ~(1 << y) & 0xFF
+        else:
+            v |= 1 << y
+        setattr(cpu, name, v)
+        return 8
+    return cb_r
+
+
+def _build_ed() -> List[Callable[[Z80], int]]:
+    table: List[Callable[[Z80], int]] = [lambda cpu: 8] * 256
+    for op in range(0x40, 0x80):
+        fn = _make_ed(op)
+        if fn is not None:
+            table[op] = fn
+    for op in (0xA0, 0xA1, 0xA2, 0xA3, 0xA8, 0xA9, 0xAA, 0xAB,
+               0xB0, 0xB1, 0xB2, 0xB3, 0xB8, 0xB9, 0xBA, 0xBB):
+        table[op] = _make_block(op)
+    return table
+
+
+def _make_ed(op: int) -> Optional[Callable[[Z80], int]]:  # noqa: C901
+    y, z = (op >> 3) & 7, op & 7
+    p, q = y >> 1, y & 1
+    if z == 0:
+        name = _R8[y]
+
+        def in_r_c(cpu: Z80) -> int:
+            v = cpu.port_in(cpu.bc) & 0xFF
+            if name is not None:
+                setattr(cpu, name, v)
+            cpu.f = (cpu.f & FLAG_C) | SZP[v]
+            return 12
+        return in_r_c
+    if z == 1:
+        name = _R8[y]
+
+        def out_c_r(cpu: Z80) -> int:
+            cpu.port_out(cpu.bc, getattr(cpu, name) if name is not None else 0)
+            return 12
+        return out_c_r
+    if z == 2:
+        rp_get = _rp_get(p, None)
+        if q == 0:
+            def sbc_hl(cpu: Z80) -> int:
+                _sbc16(cpu, rp_get(cpu))
+                return 15
+            return sbc_hl
+
+        def adc_hl(cpu: Z80) -> int:
+            _adc16(cpu, rp_get(cpu))
+            return 15
+        return adc_hl
+    if z == 3:
+        rp_get = _rp_get(p, None)
+        rp_set = _rp_set(p, None)
+        if q == 0:
+            def ld_nn_rp(cpu: Z80) -> int:
+                cpu.ww(cpu.fetch16(), rp_get(cpu))
+                return 20
+            return ld_nn_rp
+
+        def ld_rp_nn(cpu: Z80) -> int:
+            rp_set(cpu, cpu.rw(cpu.fetch16()))
+            return 20
+        return ld_rp_nn
+    if z == 4:
+        def neg(cpu: Z80) -> int:
+            v = cpu.a
+            cpu.a = 0
+            _sub8(cpu, v, 0)
+            return 8
+        return neg
+    if z == 5:
+        def retn(cpu: Z80) -> int:
+            cpu.iff1 = cpu.iff2
+            cpu.pc = cpu.pop()
+            return 14
+        return retn
+    if z == 6:
+        mode = (0, 0, 1, 2)[y & 3]
+
+        def im(cpu: Z80) -> int:
+            cpu.im = mode
+            return 8
+        return im
+    if y == 0:
+        def ld_i_a(cpu: Z80) -> int:
+            cpu.i = cpu.a
+            return 9
+        return ld_i_a
+    if y == 1:
+        def ld_r_a(cpu: Z80) -> int:
+            cpu.r = cpu.a
+            return 9
+        return ld_r_a
+    if y in (2, 3):
+        def ld_a_ir(cpu: Z80) -> int:
+            cpu.a = cpu.i if y == 2 else cpu.r
+            cpu.f = (cpu.f & FLAG_C) | SZ[cpu.a] | (FLAG_PV if cpu.iff2 else 0)
+            return 9
+        return ld_a_ir
+    if y == 4:
+        def rrd(cpu: Z80) -> int:
+            addr = cpu.hl
+            m = cpu.mem[addr]
+            cpu.wb(addr, ((cpu.a << 4) | (m >> 4)) & 0xFF)
+            cpu.a = (cpu.a & 0xF0) | (m & 0x0F)
+            cpu.f = (cpu.f & FLAG_C) | SZP[cpu.a]
+            return 18
+        return rrd
+    if y == 5:
+        def rld(cpu: Z80) -> int:
+            addr = cpu.hl
+            m = cpu.mem[addr]
+            cpu.wb(addr, ((m << 4) | (cpu.a & 0x0F)) & 0xFF)
+            cpu.a = (cpu.a & 0xF0) | (m >> 4)
+            cpu.f = (cpu.f & FLAG_C) | SZP[cpu.a]
+            return 18
+        return rld
+    return None
+
+
+def _make_block(op: int) -> Callable[[Z80], int]:
+    kind = op & 3
+    step = -1 if op & 0x08 else 1
+    repeat = bool(op & 0x10)
+
+    if kind == 0:  # LDI/LDD/LDIR/LDDR
+        def ld_block(cpu: Z80) -> int:
+            v = cpu.mem[cpu.hl]
+            cpu.wb(cpu.de, v)
+            cpu.hl = (cpu.hl + step) & 0xFFFF
+            cpu.de = (cpu.de + step) & 0xFFFF
+            bc = (cpu.bc - 1) & 0xFFFF
+            cpu.bc = bc
+            n = (v + cpu.a) & 0xFF
+            cpu.f = ((cpu.f & (FLAG_S | FLAG_Z | FLAG_C)) | (FLAG_PV if bc else 0)
+                     | (n & FLAG_X) | ((n << 4) & FLAG_Y))
+            if repeat and bc:
+                cpu.pc = (cpu.pc - 2) & 0xFFFF
+                return 21
+            return 16
+        return ld_block
+    if kind == 1:  # CPI/CPD/CPIR/CPDR
+        def cp_block(cpu: Z80) -> int:
+            v = cpu.mem[cpu.hl]
+            res = (cpu.a - v) & 0xFF
+            h = (cpu.a ^ v ^ res) & FLAG_H
+            cpu.hl = (cpu.hl + step) & 0xFFFF
+            bc = (cpu.bc - 1) & 0xFFFF
+            cpu.bc = bc
+            cpu.f = ((cpu.f & FLAG_C) | (SZ[res] & ~(FLAG_X | FLAG_Y)) | h | FLAG_N
+                     | (FLAG_PV if bc else 0))
+            if repeat and bc and res:
+                cpu.pc = (cpu.pc - 2) & 0xFFFF
+                return 21
+            return 16
+        return cp_block
+    if kind == 2:  # INI/IND/INIR/INDR
+        def in_block(cpu: Z80) -> int:
+            v = cpu.port_in(cpu.bc) & 0xFF
+            cpu.wb(cpu.hl, v)
+            cpu.hl = (cpu.hl + step) & 0xFFFF
+            cpu.b = (cpu.b - 1) & 0xFF
+            cpu.f = SZ[cpu.b] | FLAG_N
+            if repeat and cpu.b:
+                cpu.pc = (cpu.pc - 2) & 0xFFFF
+                return 21
+            return 16
+        return in_block
+
+    def out_block(cpu: Z80) -> int:  # OUTI/OUTD/OTIR/OTDR
+        v = cpu.mem[cpu.hl]
+        cpu.b = (cpu.b - 1) & 0xFF
+        cpu.port_out(cpu.bc, v)
+        cpu.hl = (cpu.hl + step) & 0xFFFF
+        cpu.f = SZ[cpu.b] | FLAG_N
+        if repeat and cpu.b:
+            cpu.pc = (cpu.pc - 2) & 0xFFFF
+            return 21
+        return 16
+    return out_block
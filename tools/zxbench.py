@@ -0,0 +1,1058 @@
+#!/usr/bin/env python3
+"""Headless T-state benchmark for the resident SpecTalkZX binary.
+
+Loads the built CODE block from build/SpecTalkZX.tap at ZORG, runs it on the
+pure-Python core in tools/z80emu.py as a 48K Spectrum with an esxDOS RST 8
+trap and a ZX-Uno UART (0xFC3B select / 0xFD3B data) clocked at 115200 baud,
+lets the real esp_init() boot against a minimal AT responder, then replays an
+IRC capture through the UART FIFO and reports where the T-states went.
+
+Timing is uncontended 3.5 MHz (no ULA contention, no divMMC wait states), so
+numbers compare builds against each other; they are not wall-clock truth.
+Without --rom the IM1 handler is a FRAMES-only stub, cheaper than the ROM's
+keyboard scan; pass a 48K ROM image for frame-exact interrupt cost.
+--model 128 adds $7FFD paging of eight RAM banks at $C000 (make bank128).
+
+--type and --more-frames drive the keyboard matrix: type a command at a
+given replay time and answer each MORE prompt after a fixed wait, so a
+paginated reply (the irc_corpus.py pagenames capture) runs with the prompt
+up while the flood keeps arriving.
+
+--dispatch times parse_irc_message()'s command dispatch on the real code:
+from the last_cmd_id store to the entry of the CMD_TABLE handler (or the
+default handler) it reaches, per command id (make cmdbench).
+
+Usage:
+    python tools/zxbench.py --capture session.irc
+    python tools/zxbench.py --capture session.irc --fifo 1 --json out.json
+    python tools/zxbench.py --capture build/corpus/pagenames.srx \
+        --type "0.5:/names #bigchan" --more-frames 100
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import re
+import shutil
+import sys
+import tempfile
+from collections import deque
+from pathlib import Path
+from typing import Callable, Dict, List, Optional, Tuple
+
+sys.path.insert(0, str(Path(__file__).resolve().parent))
+from z80emu import Z80  # noqa: E402
+
+CPU_HZ = 3_500_000
+FRAME_T = 69_888
+INT_LEN_T = 32
+BAUD = 115_200
+ZORG = 24000
+FRAMES_ADDR = 23672
+ERR_SP_ADDR = 23613
+
+ZXUNO_ADDR = 0xFC3B
+ZXUNO_REG = 0xFD3B
+BANKM_ADDR = 0x5B5C  # 128K ROM copy of the last $7FFD write
+UART_DATA_REG = 0xC6
+UART_STAT_REG = 0xC7
+UART_RX_READY = 0x80
+
+STATE_IRC_READY = 3
+
+# FrameEst (include/spectalk.h): hist[5] buckets, then the worst estimate.
+FRAME_BUCKETS = ("1", "2", "3-4", "5-8", ">8")
+STACK_BYTES = 512
+
+DEFAULT_WATCH = [
+    "_try_read_line_nodrain",
+    "_try_read_line_zc",
+    "_parse_irc_message",
+    "_utf8_to_ascii",
+    "_main_print",
+    "_scroll_main_zone",
+]
+
+DEFAULT_CFG = (
+    "nick=benchzx\r\n"
+    "server=irc.bench.invalid\r\n"
+    "port=6667\r\n"
+    "autoconnect=0\r\n"
+    "tz=0\r\n"
+)
+
+# Keyboard matrix, as the _in_inkey table in 80_ui_runtime.asm: half-row n
+# is selected by address bit 8+n low, key k reads as data bit k low.
+# Each entry maps a character to (row, bit) plus an optional shift key.
+KEY_ROWS = ("\x00zxcv", "asdfg", "qwert", "12345", "09876", "poiuy", "\rlkjh", " \x00mnb")
+KEY_SYM_ROWS = ("\x00:`?/", "~|\\{}", "\x00\x00\x00<>", "!@#$%", "_)('&",
+                "\";\x00][", "\x00=+-^", "\x00\x00.,*")
+KEY_CAPS = (0, 0)
+KEY_SYM = (7, 1)
+KEY_HOLD_FRAMES = 3     # read_key() needs a release between equal keys
+
+
+def key_map() -> Dict[str, Tuple[Tuple[int, int], Optional[Tuple[int, int]]]]:
+    keys: Dict[str, Tuple[Tuple[int, int], Optional[Tuple[int, int]]]] = {}
+    for row, chars in enumerate(KEY_ROWS):
+        for bit, ch in enumerate(chars):
+            if ch != "\x00":
+                keys[ch] = ((row, bit), None)
+                if ch.isalpha():
+                    keys[ch.upper()] = ((row, bit), KEY_CAPS)
+    for row, chars in enumerate(KEY_SYM_ROWS):
+        for bit, ch in enumerate(chars):
+            if ch != "\x00" and ch not in keys:
+                keys[ch] = ((row, bit), KEY_SYM)
+    keys["\n"] = keys["\r"]
+    return keys
+
+
+MAP_RE = re.compile(r"^(\w+)\s+=\s+\$([0-9A-Fa-f]+)\s+;")
+
+
+# =============================================================================
+# Build artefacts
+# =============================================================================
+
+def parse_map(path: Path) -> Dict[str, int]:
+    symbols: Dict[str, int] = {}
+    for line in path.read_text(errors="replace").splitlines():
+        m = MAP_RE.match(line.strip())
+        if m and m.group(1) not in symbols:
+            symbols[m.group(1)] = int(m.group(2), 16)
+    return symbols
+
+
+def load_tap_code(path: Path) -> Tuple[int, bytes]:
+    """Return (load address, payload) of the first CODE block in a TAP."""
+    data = path.read_bytes()
+    pos = 0
+    header: Optional[bytes] = None
+    while pos + 2 <= len(data):
+        size = data[pos] | (data[pos + 1] << 8)
+        block = data[pos + 2:pos + 2 + size]
+        pos += 2 + size
+        if len(block) < 2:
+            break
+        if block[0] == 0x00 and len(block) >= 19:
+            header = block
+        elif block[0] == 0xFF and header is not None:
+            if header[1] == 3:
+                start = header[14] | (header[15] << 8)
+                return start, block[1:-1]
+            header = None
+    raise ValueError(f"{path}: no CODE block found")
+
+
+# =============================================================================
+# Capture input
+# =============================================================================
+
+Chunk = Tuple[float, bytes]  # (release time in seconds from replay start, bytes)
+
+
+def read_capture(path: Path) -> List[Chunk]:
+    """SRX1 timed stream (tools/irc_corpus.py) or a raw byte capture.
+
+    A raw capture is one burst at t=0, paced only by the baud rate.
+    """
+    data = path.read_bytes()
+    if not data.startswith(b"SRX1") or len(data) < 5:
+        return [(0.0, data)]
+    tick_s = data[4] / 1000.0
+    chunks: List[Chunk] = []
+    pos, now = 5, 0.0
+    while pos + 4 <= len(data):
+        delta = data[pos] | (data[pos + 1] << 8)
+        size = data[pos + 2] | (data[pos + 3] << 8)
+        now += delta * tick_s
+        if size:
+            chunks.append((now, data[pos + 4:pos + 4 + size]))
+        pos += 4 + size
+    return chunks
+
+
+# =============================================================================
+# Peripherals
+# =============================================================================
+
+class Uart:
+    """ZX-Uno UART receive side with a bounded FIFO and overrun accounting.
+
+    Arrivals are computed lazily from the byte clock whenever the CPU reads
+    the status or data register, so no per-byte events are scheduled.
+    """
+
+    def __init__(self, cpu: Z80, fifo_depth: int, baud: int = BAUD) -> None:
+        self.cpu = cpu
+        self.fifo_depth = max(1, fifo_depth)
+        self.byte_t = CPU_HZ * 10 / baud  # 8N1
+        self.fifo: deque = deque()
+        self.pending: deque = deque()  # [start_t, bytes, next_index]
+        self.line_free_t = 0.0
+        self.selected = 0
+        self.delivered = 0
+        self.dropped = 0
+        self.tx_sink: Callable[[int], None] = lambda byte: None
+
+    def queue(self, release_t: float, payload: bytes) -> None:
+        if payload:
+            self.pending.append([release_t, payload, 0])
+
+    def idle(self) -> bool:
+        return not self.pending and not self.fifo
+
+    def _advance(self) -> None:
+        now = self.cpu.t
+        pending = self.pending
+        while pending:
+            chunk = pending[0]
+            start = max(chunk[0], self.line_free_t)
+            payload, idx = chunk[1], chunk[2]
+            if start > now:
+                return
+            arrived = int((now - start) / self.byte_t) + 1
+            end = min(len(payload), idx + arrived)
+            for i in range(idx, end):
+                if len(self.fifo) < self.fifo_depth:
+                    self.fifo.append(payload[i])
+                else:
+                    self.dropped += 1
+            self.line_free_t = start + (end - idx) * self.byte_t
+            if end < len(payload):
+                chunk[0] = self.line_free_t
+                chunk[2] = end
+                return
+            pending.popleft()
+
+    def port_in(self) -> int:
+        self._advance()
+        if self.selected == UART_STAT_REG:
+            return UART_RX_READY if self.fifo else 0x00
+        if self.selected == UART_DATA_REG and self.fifo:
+            self.delivered += 1
+            return self.fifo.popleft()
+        return 0x00
+
+    def port_out(self, value: int) -> None:
+        if self.selected == UART_DATA_REG:
+            self.tx_sink(value)
+
+
+class AtResponder:
+    """Just enough ESP-AT for esp_init(): OK to everything, an IP and an AP."""
+
+    REPLIES = {
+        "AT+CIFSR": b'+CIFSR:STAIP,"192.168.1.50"\r\n+CIFSR:STAMAC,"5c:cf:7f:00:00:01"\r\n\r\nOK\r\n',
+        "AT+CWJAP?": b'+CWJAP:"benchnet","00:11:22:33:44:55",6,-48\r\n\r\nOK\r\n',
+        "AT+CIPSNTPTIME?": b"+CIPSNTPTIME:Fri Oct 16 12:00:00 2026\r\nOK\r\n",
+    }
+
+    def __init__(self, uart: Uart, latency_t: int = 7000) -> None:
+        self.uart = uart
+        self.latency_t = latency_t
+        self.buf = bytearray()
+        self.enabled = True
+        self.log: List[str] = []
+
+    def tx(self, byte: int) -> None:
+        if not self.enabled:
+            return
+        if byte in (0x0D, 0x0A):
+            if self.buf:
+                self._command(self.buf.decode("latin-1"))
+                self.buf.clear()
+            return
+        self.buf.append(byte)
+
+    def _command(self, line: str) -> None:
+        line = line.lstrip("+")  # "+++" has no terminator and prefixes the next command
+        self.log.append(line)
+        if not line.upper().startswith("AT"):
+            return
+        reply = self.REPLIES.get(line.upper(), b"OK\r\n")
+        self.uart.queue(self.uart.cpu.t + self.latency_t, reply)
+
+
+class EsxDos:
+    """RST 8 trap: files come from a sandbox first, then the build tree."""
+
+    def __init__(self, cpu: Z80, search: List[Path], sandbox: Path,
+                 call_t: int = 2000, byte_t: int = 40) -> None:
+        self.cpu = cpu
+        self.search = search
+        self.sandbox = sandbox
+        self.call_t = call_t
+        self.byte_t = byte_t
+        self.handles: Dict[int, list] = {}
+        self.calls = 0
+
+    def _resolve(self, raw: str, write: bool) -> Optional[Path]:
+        rel = raw.replace("\\", "/").lstrip("/")
+        if not rel:
+            return None
+        sand = self.sandbox / rel
+        if write or sand.exists():
+            return sand
+        for base in self.search:
+            for cand in (base / rel, base / Path(rel).name):
+                if cand.exists():
+                    return cand
+        return None
+
+    def _cstr(self, addr: int) -> str:
+        out = bytearray()
+        mem = self.cpu.mem
+        while mem[addr] and len(out) < 255:
+            out.append(mem[addr])
+            addr = (addr + 1) & 0xFFFF
+        return out.decode("latin-1")
+
+    def trap(self, cpu: Z80) -> bool:
+        ret = cpu.pop()
+        func = cpu.mem[ret]
+        cpu.pc = (ret + 1) & 0xFFFF
+        self.calls += 1
+        cpu.t += self.call_t
+        ok = self._dispatch(cpu, func)
+        cpu.f = (cpu.f & ~0x01) | (0 if ok else 0x01)
+        return True
+
+    def _dispatch(self, cpu: Z80, func: int) -> bool:  # noqa: C901
+        if func == 0x89:  # M_GETSETDRV
+            cpu.a = ord("C")
+            return True
+        if func == 0x9A:  # F_OPEN
+            mode = cpu.b
+            write = bool(mode & 0x0E)
+            path = self._resolve(self._cstr(cpu.ix), write)
+            if path is None or (not write and not path.exists()):
+                cpu.a = 5
+                return False
+            if write:
+                path.parent.mkdir(parents=True, exist_ok=True)
+                data = bytearray() if mode & 0x0C or not path.exists() else bytearray(path.read_bytes())
+            else:
+                data = bytearray(path.read_bytes())
+            handle = 1
+            while handle in self.handles:
+                handle += 1
+            self.handles[handle] = [path, data, 0, write]
+            cpu.a = handle
+            return True
+        entry = self.handles.get(cpu.a)
+        if func == 0x9B:  # F_CLOSE
+            if entry is None:
+                return False
+            path, data, _, write = entry
+            if write:
+                path.write_bytes(bytes(data))
+            del self.handles[cpu.a]
+            return True
+        if entry is None:
+            cpu.a = 5
+            return False
+        path, data, pos, _ = entry
+        if func == 0x9D:  # F_READ
+            n = min(cpu.bc, max(0, len(data) - pos))
+            for i in range(n):
+                cpu.wb(cpu.ix + i, data[pos + i])
+            entry[2] = pos + n
+            cpu.bc = n
+            cpu.t += n * self.byte_t
+            return True
+        if func == 0x9E:  # F_WRITE
+            n = cpu.bc
+            chunk = bytes(cpu.mem[(cpu.ix + i) & 0xFFFF] for i in range(n))
+            if pos > len(data):
+                data.extend(bytes(pos - len(data)))
+            data[pos:pos + n] = chunk
+            entry[2] = pos + n
+            cpu.t += n * self.byte_t
+            return True
+        if func == 0x9F:  # F_SEEK
+            off = (cpu.b << 24) | (cpu.c << 16) | (cpu.d << 8) | cpu.e
+            mode = cpu.ix & 0xFF
+            new = off if mode == 0 else pos + off if mode == 1 else pos - off
+            entry[2] = max(0, new)
+            return True
+        return False
+
+
+# =============================================================================
+# Machine
+# =============================================================================
+
+class Spectrum48:
+    def __init__(self, tap: Path, symbols: Dict[str, int], rom: Optional[Path],
+                 fifo_depth: int, search: List[Path], sandbox: Path,
+                 model: int = 48) -> None:
+        self.cpu = cpu = Z80()
+        self.sym = symbols
+        start, code = load_tap_code(tap)
+        cpu.mem[start:start + len(code)] = code
+        self.entry = start
+        if rom is not None:
+            rom_bytes = rom.read_bytes()[:0x4000]
+            cpu.mem[0:len(rom_bytes)] = rom_bytes
+        else:
+            cpu.mem[0x0038:0x0038 + len(_STUB_ISR)] = _STUB_ISR
+            # 48K ROM bytes a make im2 build checks before it enables IM2.
+            cpu.mem[0x0000] = 0xF3
+            cpu.mem[_ROM_FF_FILL[0]:_ROM_FF_FILL[1]] = b"\xFF" * (_ROM_FF_FILL[1] - _ROM_FF_FILL[0])
+        cpu.rom_top = 0x4000
+        # 128K: banks[n] holds bank n while it is not paged in at $C000.
+        self.banks: Optional[List[bytearray]] = None
+        self.bank_cur = 0
+        self.bank_locked = False
+        if model == 128:
+            self.banks = [bytearray(0x4000) for _ in range(8)]
+            cpu.mem[BANKM_ADDR] = 0x10  # USR 0: 48K BASIC ROM, bank 0
+        self.uart = Uart(cpu, fifo_depth)
+        self.at = AtResponder(self.uart)
+        self.uart.tx_sink = self.at.tx
+        self.esx = EsxDos(cpu, search, sandbox)
+        cpu.traps[0x0008] = self.esx.trap
+        cpu.port_in = self._port_in
+        cpu.port_out = self._port_out
+        cpu.on_event = self._event
+        self.int_t = FRAME_T
+        self.frames = 0
+        self.frame_hooks: List[Callable[[], None]] = []
+        self.timed: List[Tuple[int, Callable[[], None]]] = []
+        self.stop = False
+        self.keys_down: set = set()
+        self.key_queue: deque = deque()
+        self.key_wait = 0
+        self.frame_hooks.append(self._key_frame)
+        cpu.pc = start
+        cpu.sp = 0xFF58
+        cpu.iy = 0x5C3A
+        cpu.im = 1
+        cpu.mem[ERR_SP_ADDR] = 0x54
+        cpu.mem[ERR_SP_ADDR + 1] = 0xFF
+        self._schedule()
+
+    # -- ports ------------------------------------------------------------
+    def _port_in(self, port: int) -> int:
+        if port == ZXUNO_REG:
+            return self.uart.port_in()
+        if port & 1 or not self.keys_down:
+            return 0xFF  # nothing else is decoded
+        value = 0xFF
+        for row, bit in self.keys_down:
+            if not port & (0x100 << row):
+                value &= ~(1 << bit)
+        return value
+
+    def _port_out(self, port: int, value: int) -> None:
+        if port == ZXUNO_ADDR:
+            self.uart.selected = value
+        elif port == ZXUNO_REG:
+            self.uart.port_out(value)
+        elif self.banks is not None and not port & 0x8002 and not self.bank_locked:
+            self._page(value & 7)
+            self.bank_locked = bool(value & 0x20)
+
+    def _page(self, bank: int) -> None:
+        if bank == self.bank_cur:
+            return
+        mem = self.cpu.mem
+        self.banks[self.bank_cur][:] = mem[0xC000:]
+        mem[0xC000:] = self.banks[bank]
+        self.bank_cur = bank
+
+    # -- keyboard ---------------------------------------------------------
+    def type_text(self, text: str) -> None:
+        """Queue key presses, each held KEY_HOLD_FRAMES then released as long."""
+        keys = key_map()
+        for ch in text:
+            if ch not in keys:
+                raise SystemExit(f"zxbench: no key for {ch!r}")
+            key, shift = keys[ch]
+            self.key_queue.append({key, shift} - {None})
+
+    def _key_frame(self) -> None:
+        if self.key_wait:
+            self.key_wait -= 1
+            return
+        if self.keys_down:
+            self.keys_down = set()
+        elif self.key_queue:
+            self.keys_down = self.key_queue.popleft()
+        else:
+            return
+        self.key_wait = KEY_HOLD_FRAMES - 1
+
+    # -- timing -----------------------------------------------------------
+    def add_timer(self, at_t: int, fn: Callable[[], None]) -> None:
+        self.timed.append((at_t, fn))
+        self.timed.sort(key=lambda item: item[0])
+        self._schedule()
+
+    def _schedule(self) -> None:
+        nxt = self.int_t
+        if self.timed:
+            nxt = min(nxt, self.timed[0][0])
+        self.cpu.next_event = nxt
+
+    def _event(self, cpu: Z80) -> None:
+        while self.timed and self.timed[0][0] <= cpu.t:
+            _, fn = self.timed.pop(0)
+            fn()
+        if cpu.t >= self.int_t:
+            if cpu.interrupt():
+                self._frame_done()
+            elif cpu.t >= self.int_t + INT_LEN_T:
+                self._frame_done()
+            else:
+                cpu.next_event = cpu.t + 1
+                return
+        self._schedule()
+
+    def _frame_done(self) -> None:
+        self.frames += 1
+        self.int_t += FRAME_T
+        for hook in self.frame_hooks:
+            hook()
+
+    def run(self, max_t: int) -> None:
+        cpu = self.cpu
+        while not self.stop and cpu.t < max_t:
+            if cpu.halted and not cpu.iff1:
+                raise RuntimeError(f"DI+HALT at PC={cpu.pc:04X}")
+            cpu.run_until(min(max_t, cpu.t + FRAME_T))
+
+    def sym_addr(self, name: str) -> Optional[int]:
+        return self.sym.get(name)
+
+    def add_trap(self, addr: int, fn: Callable[[Z80], bool]) -> None:
+        """Install a PC trap, chaining after any trap already at addr."""
+        prev = self.cpu.traps.get(addr)
+        if prev is None:
+            self.cpu.traps[addr] = fn
+        else:
+            self.cpu.traps[addr] = lambda cpu, a=prev, b=fn: a(cpu) or b(cpu)
+
+
+# $FF run in the 48K ROM that IM2 builds use as their vector table.
+_ROM_FF_FILL = (0x386E, 0x3D00)
+
+# IM1 stand-in when no ROM is supplied: bump the FRAMES word, EI, RET.
+_STUB_ISR = bytes([
+    0xE5,                   # push hl
+    0x2A, 0x78, 0x5C,       # ld hl,(FRAMES)
+    0x23,                   # inc hl
+    0x22, 0x78, 0x5C,       # ld (FRAMES),hl
+    0xE1,                   # pop hl
+    0xFB,                   # ei
+    0xC9,                   # ret
+])
+
+
+# =============================================================================
+# Function timing
+# =============================================================================
+
+class FunctionTimer:
+    """Inclusive T-states per watched entry point.
+
+    Entry is a PC trap on the symbol; exit is the first return to the
+    caller's address with SP above the entry SP, which also covers callee
+    cleanup, `jp (hl)` returns and tail jumps into the watched routine.
+    """
+
+    def __init__(self, machine: Spectrum48, names: List[str]) -> None:
+        self.m = machine
+        self.cpu = machine.cpu
+        self.active = False
+        self.stats: Dict[str, List[int]] = {}
+        self.frames: List[Tuple[str, int, int, int]] = []
+        self.depth: Dict[str, int] = {}
+        self.ret_traps: Dict[int, int] = {}
+        self.on_return: Dict[str, Callable[[Z80], None]] = {}
+        self.missing: List[str] = []
+        for name in names:
+            addr = machine.sym_addr(name)
+            if addr is None:
+                self.missing.append(name)
+                continue
+            self.stats[name] = [0, 0]
+            self.depth[name] = 0
+            self._chain(addr, self._make_entry(name))
+
+    def _chain(self, addr: int, fn: Callable[[Z80], bool]) -> None:
+        self.m.add_trap(addr, fn)
+
+    def _make_entry(self, name: str) -> Callable[[Z80], bool]:
+        def entry(cpu: Z80) -> bool:
+            sp = cpu.sp
+            while self.frames and self.frames[-1][3] <= sp:
+                self._drop(self.frames.pop())
+            ret = cpu.rw(sp)
+            self.frames.append((name, cpu.t, ret, sp))
+            self.depth[name] += 1
+            if ret not in self.ret_traps:
+                self.ret_traps[ret] = 0
+                self._chain(ret, self._ret_check)
+            self.ret_traps[ret] += 1
+            return False
+        return entry
+
+    def _drop(self, frame: Tuple[str, int, int, int]) -> None:
+        self.depth[frame[0]] -= 1
+
+    def _ret_check(self, cpu: Z80) -> bool:
+        while self.frames:
+            name, t0, ret, sp = self.frames[-1]
+            if cpu.pc != ret or cpu.sp <= sp:
+                break
+            self.frames.pop()
+            self.depth[name] -= 1
+            if self.active and self.depth[name] == 0:
+                st = self.stats[name]
+                st[0] += 1
+                st[1] += cpu.t - t0
+            hook = self.on_return.get(name)
+            if hook is not None and self.active:
+                hook(cpu)
+        return False
+
+    def reset(self) -> None:
+        for st in self.stats.values():
+            st[0] = st[1] = 0
+
+
+class DispatchTimer:
+    """T-states of the command dispatch, per cmd_id.
+
+    parse_irc_message() stores last_cmd_id right before the dispatch; the
+    span ends on the first PC at a handler named in src/cmd_table.inc or at
+    h_numeric_default/h_default_cmd. A line that returns in between (the
+    /names filter) is dropped at the next parse_irc_message() entry.
+    """
+
+    DEFAULTS = ("h_numeric_default", "h_default_cmd")
+
+    def __init__(self, machine: Spectrum48, table: Path) -> None:
+        from gen_cmd_hash import read_rows
+        self.m = machine
+        self.active = False
+        self.t0: Optional[int] = None
+        self.stats: Dict[int, List[int]] = {}
+        self.cmd_addr = machine.sym_addr("_last_cmd_id")
+        entry = machine.sym_addr("_parse_irc_message")
+        if self.cmd_addr is None or entry is None:
+            raise SystemExit("zxbench: --dispatch needs _last_cmd_id and _parse_irc_message in the map")
+        names = sorted({fn for _, fn in read_rows(table)} | set(self.DEFAULTS))
+        self.missing = [n for n in names if machine.sym_addr("_" + n) is None]
+        if len(self.missing) == len(names):
+            raise SystemExit("zxbench: no dispatch handlers in the map")
+        for name in names:
+            addr = machine.sym_addr("_" + name)
+            if addr is not None:
+                machine.add_trap(addr, self._handler)
+        machine.add_trap(entry, self._drop)
+        cpu = machine.cpu
+        store = cpu.wb
+
+        def wb(addr: int, v: int) -> None:
+            store(addr, v)
+            if self.t0 is None and (addr - self.cmd_addr) & 0xFFFF < 2:
+                self.t0 = cpu.t
+        cpu.wb = wb
+
+    def _drop(self, cpu: Z80) -> bool:
+        self.t0 = None
+        return False
+
+    def _handler(self, cpu: Z80) -> bool:
+        if self.t0 is not None:
+            if self.active:
+                st = self.stats.setdefault(cpu.rw(self.cmd_addr), [0, 0])
+                st[0] += 1
+                st[1] += cpu.t - self.t0
+            self.t0 = None
+        return False
+
+    def report(self) -> Dict[str, object]:
+        from gen_cmd_hash import id_name
+        lines = sum(n for n, _ in self.stats.values())
+        total = sum(t for _, t in self.stats.values())
+        cmds = sorted(self.stats.items(), key=lambda kv: -kv[1][0])
+        return {
+            "lines": lines,
+            "t_per_line": round(total / max(1, lines), 1),
+            "commands": {id_name(i): {"lines": n, "t_per_line": round(t / n, 1)}
+                         for i, (n, t) in cmds},
+            "missing_handlers": self.missing,
+        }
+
+
+# =============================================================================
+# Bench driver
+# =============================================================================
+
+def make_machine(args: argparse.Namespace, symbols: Dict[str, int],
+                 cfg_text: Optional[str] = None) -> Tuple[Spectrum48, Path]:
+    """Spectrum48 with the TAP loaded and a throwaway esxDOS sandbox.
+
+    The caller owns the sandbox directory and removes it when done.
+    cfg_text overrides --cfg and DEFAULT_CFG.
+    """
+    sandbox = Path(tempfile.mkdtemp(prefix="zxbench_"))
+    cfg = sandbox / "SYS" / "CONFIG" / "SPECTALK.CFG"
+    cfg.parent.mkdir(parents=True)
+    if cfg_text is None:
+        cfg_text = args.cfg.read_text() if args.cfg else DEFAULT_CFG
+    cfg.write_text(cfg_text)
+    search = [args.build_dir, Path("src")]
+    return Spectrum48(args.tap, symbols, args.rom, args.fifo, search, sandbox,
+                      getattr(args, "model", 48)), sandbox
+
+
+class Bench:
+    def __init__(self, args: argparse.Namespace) -> None:
+        self.args = args
+        self.sym = parse_map(args.map)
+        self.m, self.sandbox = make_machine(args, self.sym)
+        watch = list(args.watch)
+        if args.more_frames is not None and "_pagination_pause" not in watch:
+            watch.append("_pagination_pause")
+        if "_frame_wait" not in watch:
+            watch.append("_frame_wait")
+        self.timer = FunctionTimer(self.m, watch)
+        self.timer.on_return["_try_read_line_nodrain"] = self._line_return
+        self.timer.on_return["_frame_wait"] = self._loop_return
+        self.capture = read_capture(args.capture)
+        self.capture_bytes = sum(len(c[1]) for c in self.capture)
+        self.capture_lines = sum(c[1].count(b"\n") for c in self.capture)
+        self.lines = 0
+        self.replay_t0 = 0
+        self.replay_f0 = 0
+        self.end_t = 0
+        self.quiet_frames = 0
+        self.more_prompts = 0
+        self.held_clobbered = 0
+        self.held: Optional[Tuple[int, bytes]] = None
+        self.loop_hist = [0] * len(FRAME_BUCKETS)
+        self.loop_worst = 0
+        self.loop_f0: Optional[int] = None
+        self.loop_hold = False
+        if args.more_frames is not None:
+            addr = self.sym.get("_pagination_pause")
+            if addr is None:
+                raise SystemExit("zxbench: _pagination_pause not in map")
+            self.m.add_trap(addr, self._more_prompt)
+            self.timer.on_return["_pagination_pause"] = self._more_return
+        addr = self.sym.get("_process_irc_data")
+        if addr is None:
+            raise SystemExit("zxbench: _process_irc_data not in map")
+        self.timer._chain(addr, self._start_replay)
+        self.dispatch = None
+        if args.dispatch:
+            self.dispatch = DispatchTimer(self.m, args.dispatch_table)
+        self.prof = None
+        if args.profile:
+            from zxprof import Profiler
+            self.prof = Profiler(self.m, args.map, args.profile,
+                                 args.build_dir / "SPECTALK.OVL", Path("overlay"),
+                                 args.profile_locals)
+        self.m.frame_hooks.append(self._frame)
+
+    def _line_return(self, cpu: Z80) -> None:
+        if cpu.l:
+            self.lines += 1
+
+    def _loop_return(self, cpu: Z80) -> None:
+        # Real frames between frame_wait() returns: the emulator counts every
+        # interrupt, including the ones the DI mainline never sees.
+        now = self.m.frames
+        if self.loop_f0 is not None and not self.loop_hold:
+            d = now - self.loop_f0
+            if d:
+                b = d - 1 if d <= 2 else 2 if d <= 4 else 3 if d <= 8 else 4
+                self.loop_hist[b] += 1
+                self.loop_worst = max(self.loop_worst, d)
+        self.loop_f0 = now
+        self.loop_hold = False
+
+    def _held_line(self) -> Optional[Tuple[int, bytes]]:
+        """The zero-copy line handlers are reading, if one is held in the ring."""
+        held = self.sym.get("_rx_zc_held")
+        if held is None or not self.m.cpu.mem[held]:
+            return None
+        ptr = self._word("_rx_ptr")
+        mem = self.m.cpu.mem
+        end = mem.find(0, ptr, ptr + 512)
+        return None if end < 0 else (ptr, bytes(mem[ptr:end + 1]))
+
+    def _more_prompt(self, cpu: Z80) -> bool:
+        # The MORE prompt blocks while handlers still point into the held
+        # line: it must read back unchanged however long the prompt stays up.
+        self.more_prompts += 1
+        self.loop_hold = True
+        self.held = self._held_line()
+        self.m.add_timer(cpu.t + self.args.more_frames * FRAME_T,
+                         lambda: self.m.type_text(" "))
+        return False
+
+    def _more_return(self, cpu: Z80) -> None:
+        if self.held is not None:
+            ptr, data = self.held
+            if bytes(cpu.mem[ptr:ptr + len(data)]) != data:
+                self.held_clobbered += 1
+        self.held = None
+
+    def _start_replay(self, cpu: Z80) -> bool:
+        if self.timer.active:
+            return False
+        state = self.sym.get("_connection_state")
+        if state is not None:
+            cpu.mem[state] = STATE_IRC_READY
+        self.m.at.enabled = False
+        self.replay_t0 = cpu.t
+        self.replay_f0 = self.m.frames
+        for when, payload in self.capture:
+            self.m.uart.queue(cpu.t + when * CPU_HZ, payload)
+        for spec in self.args.type:
+            when, _, text = spec.partition(":")
+            self.m.add_timer(cpu.t + int(float(when) * CPU_HZ),
+                             lambda text=text: self.m.type_text(text + "\n"))
+        self.timer.reset()
+        self.timer.active = True
+        if self.dispatch is not None:
+            self.dispatch.active = True
+        if self.prof is not None:
+            self.prof.start()
+        return False
+
+    def _word(self, name: str) -> int:
+        addr = self.sym.get(name)
+        return self.m.cpu.rw(addr) if addr is not None else 0
+
+    def _frame(self) -> None:
+        if not self.timer.active:
+            return
+        busy = (not self.m.uart.idle()
+                or self._word("_rb_head") != self._word("_rb_tail")
+                or self._word("_rx_pos") != 0)
+        if busy:
+            self.quiet_frames = 0
+            self.end_t = self.m.cpu.t
+            return
+        self.quiet_frames += 1
+        if self.quiet_frames >= self.args.settle_frames:
+            self.m.stop = True
+
+    def _rx_stats(self) -> Optional[Dict[str, int]]:
+        """Resident RxStats (peak/full/lost/pressure/bursts) when the build has it."""
+        addr = self.sym.get("_rx_stats")
+        if addr is None:
+            return None
+        names = ("peak", "full", "lost", "pressure", "bursts")
+        return {n: self.m.cpu.rw(addr + 2 * i) for i, n in enumerate(names)}
+
+    def _frame_est(self) -> Optional[Dict[str, object]]:
+        """Resident FrameEst: the cost-estimated iteration histogram."""
+        addr = self.sym.get("_frame_est")
+        if addr is None:
+            return None
+        hist = {b: self.m.cpu.rw(addr + 2 * i) for i, b in enumerate(FRAME_BUCKETS)}
+        return {"hist": hist, "worst": self.m.cpu.rw(addr + 10)}
+
+    def _stack_stats(self) -> Optional[Dict[str, object]]:
+        """StackStats from a make stackprobe build: peak depth and its tag."""
+        addr = self.sym.get("_stack_stats")
+        if addr is None:
+            return None
+        return {"peak": self.m.cpu.rw(addr),
+                "size": STACK_BYTES,
+                "tag": stack_tag_name(self.m.cpu.rw(addr + 2))}
+
+    def _trace(self) -> Optional[List[Dict[str, object]]]:
+        """TraceRing from a make trace build, decoded by tools/zxtrace.py."""
+        addr = self.sym.get("_trace_ring")
+        if addr is None:
+            return None
+        from zxtrace import RING_BYTES, decode
+        return decode(bytes(self.m.cpu.mem[addr:addr + RING_BYTES]))
+
+    def run(self) -> dict:
+        max_t = int(self.args.max_seconds * CPU_HZ)
+        try:
+            self.m.run(max_t)
+        finally:
+            shutil.rmtree(self.sandbox, ignore_errors=True)
+        if not self.timer.active:
+            raise SystemExit("zxbench: boot never reached process_irc_data "
+                             f"(PC={self.m.cpu.pc:04X}, frames={self.m.frames})")
+        return self.report()
+
+    def report(self) -> dict:
+        lines = max(1, self.lines)
+        span_t = max(1, (self.end_t or self.m.cpu.t) - self.replay_t0)
+        funcs = {}
+        for name, (calls, total) in self.timer.stats.items():
+            funcs[name.lstrip("_")] = {
+                "calls": calls,
+                "t_total": total,
+                "t_per_line": round(total / lines, 1),
+            }
+        return {
+            "tap": str(self.args.tap),
+            "capture": str(self.args.capture),
+            "fifo_depth": self.args.fifo,
+            "capture_bytes": self.capture_bytes,
+            "capture_lines": self.capture_lines,
+            "lines_parsed": self.lines,
+            "uart_bytes_delivered": self.m.uart.delivered,
+            "uart_overrun_drops": self.m.uart.dropped,
+            "replay_t": span_t,
+            "replay_frames": round(span_t / FRAME_T, 1),
+            "frames_per_1000_lines": round(span_t / FRAME_T * 1000 / lines, 1),
+            "functions": funcs,
+            "missing_symbols": self.timer.missing,
+            "esx_calls": self.m.esx.calls,
+            "rx_stats": self._rx_stats(),
+            "more_prompts": self.more_prompts,
+            "held_line_clobbered": self.held_clobbered,
+            "loop_frames": None if "_frame_wait" in self.timer.missing else {
+                "hist": dict(zip(FRAME_BUCKETS, self.loop_hist)),
+                "worst": self.loop_worst,
+            },
+            "frame_est": self._frame_est(),
+            "stack_stats": self._stack_stats(),
+            "trace": self._trace(),
+            "dispatch": self.dispatch.report() if self.dispatch is not None else None,
+            "profile": self.prof.report() if self.prof is not None else None,
+        }
+
+
+def stack_tag_name(tag: int) -> str:
+    """Decode a StackStats tag the way SPCTLK4 prints it."""
+    if tag == 0:
+        return "loop"
+    if tag < 1000:
+        return str(tag)
+    text = chr(tag >> 8) + chr(tag & 0xFF)
+    return "/" + text if tag & 0x2000 else text
+
+
+def print_report(rep: dict) -> None:
+    print("SpecTalkZX bench (uncontended T-states)")
+    print(f"  capture      : {rep['capture']} ({rep['capture_bytes']} B, {rep['capture_lines']} lines)")
+    print(f"  parsed lines : {rep['lines_parsed']}")
+    print(f"  UART FIFO    : depth {rep['fifo_depth']}, overrun drops {rep['uart_overrun_drops']}")
+    if rep["rx_stats"] is not None:
+        st = rep["rx_stats"]
+        print(f"  RX ring      : peak {st['peak']}, full {st['full']}, "
+              f"lost lines {st['lost']}, pressure {st['pressure']}, "
+              f"loss markers {st['bursts']}")
+    if rep["more_prompts"]:
+        print(f"  MORE prompts : {rep['more_prompts']}, "
+              f"held line clobbered {rep['held_line_clobbered']}")
+    if rep["loop_frames"] is not None:
+        lf = rep["loop_frames"]
+        hist = " ".join(f"{b}:{n}" for b, n in lf["hist"].items())
+        print(f"  loop frames  : {hist}, worst {lf['worst']} (measured)")
+    if rep["frame_est"] is not None:
+        fe = rep["frame_est"]
+        hist = " ".join(f"{b}:{n}" for b, n in fe["hist"].items())
+        print(f"  loop est.    : {hist}, worst {fe['worst']} (resident !status estimate)")
+    if rep["stack_stats"] is not None:
+        ss = rep["stack_stats"]
+        print(f"  stack peak   : {ss['peak']}/{ss['size']} B in {ss['tag']}")
+    if rep["trace"] is not None:
+        from zxtrace import format_events
+        print(f"  trace        : last {len(rep['trace'])} events")
+        for line in format_events(rep["trace"]):
+            print(f"  {line}")
+    print(f"  replay       : {rep['replay_t']} T = {rep['replay_frames']} frames")
+    print(f"  frames/1000  : {rep['frames_per_1000_lines']}")
+    print(f"  {'function':<24}{'calls':>8}{'T total':>14}{'T/line':>10}")
+    for name, st in rep["functions"].items():
+        print(f"  {name:<24}{st['calls']:>8}{st['t_total']:>14}{st['t_per_line']:>10}")
+    for name in rep["missing_symbols"]:
+        print(f"  {name.lstrip('_'):<24}{'(not in map)':>32}")
+    if rep["dispatch"] is not None:
+        print_dispatch(rep["dispatch"])
+    if rep["profile"] is not None:
+        from zxprof import print_profile
+        print_profile(rep["profile"])
+
+
+def print_dispatch(dsp: dict, top: int = 15) -> None:
+    print(f"  dispatch     : {dsp['lines']} lines, {dsp['t_per_line']} T/line "
+          "(last_cmd_id store to handler entry)")
+    for name, st in list(dsp["commands"].items())[:top]:
+        print(f"  {name:<24}{st['lines']:>8}{st['t_per_line']:>24}")
+    for name in dsp["missing_handlers"]:
+        print(f"  {name:<24}{'(not in map)':>32}")
+
+
+def build_arg_parser() -> argparse.ArgumentParser:
+    ap = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    ap.add_argument("--capture", type=Path, required=True, help="IRC byte stream to replay")
+    ap.add_argument("--tap", type=Path, default=Path("build/SpecTalkZX.tap"))
+    ap.add_argument("--map", type=Path, default=Path("SpecTalkZX.map"))
+    ap.add_argument("--build-dir", type=Path, default=Path("build"))
+    ap.add_argument("--rom", type=Path, help="optional 16K 48K ROM image")
+    ap.add_argument("--cfg", type=Path, help="SPECTALK.CFG to boot with (default: bench nick)")
+    ap.add_argument("--fifo", type=int, default=1, help="UART RX FIFO depth in bytes (default 1)")
+    ap.add_argument("--model", type=int, choices=(48, 128), default=48,
+                    help="128 adds $7FFD RAM paging for make bank128 builds")
+    ap.add_argument("--watch", nargs="+", default=DEFAULT_WATCH, help="map symbols to time")
+    ap.add_argument("--settle-frames", type=int, default=25,
+                    help="quiet frames after the capture drains before stopping")
+    ap.add_argument("--max-seconds", type=float, default=600.0, help="emulated time limit")
+    ap.add_argument("--json", type=Path, help="also write the report as JSON")
+    ap.add_argument("--type", action="append", default=[], metavar="SEC:TEXT",
+                    help="type TEXT and ENTER SEC seconds into the replay (repeatable)")
+    ap.add_argument("--more-frames", type=int, metavar="N",
+                    help="answer each MORE prompt with SPACE after N frames")
+    ap.add_argument("--brief", action="store_true",
+                    help="one line: UART drops, ring full/lost and frames (make drops)")
+    ap.add_argument("--dispatch", action="store_true",
+                    help="time command dispatch per cmd_id (make cmdbench)")
+    ap.add_argument("--dispatch-table", type=Path, default=Path("src/cmd_table.inc"),
+                    help="CMD_TABLE rows naming the handlers --dispatch stops at")
+    ap.add_argument("--profile", type=int, metavar="T",
+                    help="sample the PC every T T-states (tools/zxprof.py)")
+    ap.add_argument("--profile-stacks", type=Path,
+                    help="write collapsed call stacks for flamegraph tools")
+    ap.add_argument("--profile-locals", action="store_true",
+                    help="resolve to local asm labels as well as public symbols")
+    return ap
+
+
+def main() -> int:
+    args = build_arg_parser().parse_args()
+    for path in (args.tap, args.map, args.capture):
+        if not path.exists():
+            print(f"zxbench: missing {path}", file=sys.stderr)
+            return 2
+    bench = Bench(args)
+    rep = bench.run()
+    if args.brief:
+        st = rep["rx_stats"] or {"full": "-", "lost": "-"}
+        print(f"{args.capture.name:<20} drops {rep['uart_overrun_drops']:>6}  "
+              f"ring full {st['full']:>5}  lost lines {st['lost']:>4}  "
+              f"frames {rep['replay_frames']}"
+              + (f"  MORE {rep['more_prompts']} clobbered {rep['held_line_clobbered']}"
+                 if rep["more_prompts"] else ""))
+        if rep["dispatch"] is not None:
+            print_dispatch(rep["dispatch"], top=10)
+    else:
+        print_report(rep)
+    if bench.prof is not None and args.profile_stacks:
+        bench.prof.write_collapsed(args.profile_stacks)
+    if args.json:
+        args.json.write_text(json.dumps(rep, indent=2) + "\n")
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,727 @@
+#!/usr/bin/env python3
+"""ESP-AT stand-in and connect/reconnect latency bench for SpecTalkZX.
+
+Runs the built binary on the zxbench machine, but the UART talks to EspAt:
+a model of the ESP8266 AT subset SpecTalkZX uses (ATE, +++ with guard time,
+CIPMODE/CIPMUX/CIPSERVER/CIPDINFO/CIPSSLSIZE, CIFSR, CWJAP?, CIPSNTPCFG,
+CIPSNTPTIME?, CIPDOMAIN, CIPSTART TCP/SSL/UDP, CIPSEND with the '>' prompt,
+transparent mode, CIPCLOSE and CLOSED, and for make passive CIPRECVMODE,
+CIPRECVDATA and CIPSEND=<n>). Every reply is released after a
+configurable latency, so connect time is measured against a known ESP
+instead of whatever the real module and network did that day.
+
+In transparent mode the uplink is packed the way the ESP does it (a packet
+closes after PACK ms of UART silence) and handed to IrcScript, a scripted
+local IRC server driven by a small trigger/reply file (see DEFAULT_SCRIPT).
+
+The bench reports, in 50 Hz frames:
+    boot -> STATE_WIFI_OK      esp_init() through CIFSR/CWJAP?
+    /server -> 001             cmd_connect() through wait_for_connection_result
+    001 -> autojoin complete   last 366 parsed and the RX path idle
+With --cycles N the server drops the link after each autojoin and /server
+is issued again, which times the saved-session reconnect path as well.
+
+Usage:
+    python tools/zxesp.py
+    python tools/zxesp.py --ssl --latency CIPSTART=250 --latency NET=80
+    python tools/zxesp.py --cycles 3 --irc-script myserver.txt --json out.json
+    python tools/zxesp.py --passive          # after make passive
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import re
+import shutil
+import sys
+from pathlib import Path
+from typing import Callable, Dict, List, Optional, Tuple
+
+sys.path.insert(0, str(Path(__file__).resolve().parent))
+from zxbench import CPU_HZ, FRAME_T, Spectrum48, make_machine, parse_map  # noqa: E402
+
+STATE_WIFI_OK = 1
+STATE_IRC_READY = 3
+
+# Milliseconds. Command keys are the AT name without "AT+" and arguments.
+DEFAULT_LATENCY_MS: Dict[str, float] = {
+    "AT": 2.0,            # any command without its own entry
+    "CIFSR": 6.0,
+    "CWJAP?": 8.0,
+    "CIPSNTPTIME?": 4.0,
+    "CIPDOMAIN": 60.0,    # DNS lookup
+    "CIPSTART": 120.0,    # DNS + TCP handshake
+    "SSL": 900.0,         # added to CIPSTART for "SSL" links
+    "CIPSEND": 3.0,       # command to '>' prompt
+    "CIPCLOSE": 15.0,
+    "GUARD": 1000.0,      # +++ needs this much UART silence either side
+    "PACK": 20.0,         # transparent uplink: silence that closes a packet
+    "NET": 35.0,          # one way, ESP <-> IRC server
+}
+
+IP_ADDR = "192.168.1.50"
+SNTP_TIME = "Fri Oct 16 12:00:00 2026"
+PACKET_MAX = 2048
+
+DEFAULT_SCRIPT = r"""
+# Trigger lines start with '<' and hold a regex matched against each client
+# line; '<each' splits group 1 on commas and replays the block per item.
+# '< @connect' fires when CIPSTART opens the link. Reply lines start with
+# '>'; '+ms' delays a reply after the previous one, {nick} is the last NICK
+# sent and {1}.. are regex groups. '> @close' drops the link.
+< @connect
+> +150 :irc.bench NOTICE * :*** Looking up your hostname...
+< ^NICK \S+
+< ^USER \S+
+> +60 :irc.bench 001 {nick} :Welcome to the bench network {nick}
+> :irc.bench 002 {nick} :Your host is irc.bench, running bench-1.0
+> :irc.bench 003 {nick} :This server was created today
+> :irc.bench 004 {nick} irc.bench bench-1.0 iowx bklmnopst
+> :irc.bench 005 {nick} CHANTYPES=# PREFIX=(ov)@+ NETWORK=Bench :are supported by this server
+> :irc.bench 375 {nick} :- irc.bench Message of the day -
+> :irc.bench 372 {nick} :- Nothing to see here.
+> :irc.bench 376 {nick} :End of /MOTD command.
+<each ^JOIN (\S+)
+> +30 :{nick}!bench@zx.bench JOIN {1}
+> :irc.bench 332 {nick} {1} :Bench channel {1}
+> :irc.bench 353 {nick} = {1} :{nick} @op +voice alice bob carol dave
+> :irc.bench 366 {nick} {1} :End of /NAMES list.
+< ^PING (.*)
+> :irc.bench PONG irc.bench {1}
+< ^QUIT
+> ERROR :Closing link
+> @close
+"""
+
+
+# =============================================================================
+# Scripted IRC server
+# =============================================================================
+
+class Rule:
+    def __init__(self, pattern: str, each: bool) -> None:
+        self.pattern = pattern
+        self.regex = None if pattern == "@connect" else re.compile(pattern)
+        self.each = each
+        self.replies: List[Tuple[float, str]] = []
+
+
+def parse_script(text: str) -> List[Rule]:
+    rules: List[Rule] = []
+    for num, raw in enumerate(text.splitlines(), 1):
+        line = raw.rstrip()
+        if not line or line.lstrip().startswith("#"):
+            continue
+        if line.startswith("<"):
+            head, _, pattern = line[1:].partition(" ")
+            if head not in ("", "each") or not pattern.strip():
+                raise ValueError(f"script line {num}: bad trigger {line!r}")
+            rules.append(Rule(pattern.strip(), head == "each"))
+        elif line.startswith(">"):
+            if not rules:
+                raise ValueError(f"script line {num}: reply before any trigger")
+            body = line[1:].strip()
+            delay = 0.0
+            if body.startswith("+"):
+                ms, _, body = body[1:].partition(" ")
+                delay = float(ms)
+            rules[-1].replies.append((delay, body))
+        else:
+            raise ValueError(f"script line {num}: expected '<' or '>'")
+    return rules
+
+
+class IrcScript:
+    """Line-oriented fake IRC server; replies go back through EspAt.downlink."""
+
+    def __init__(self, text: str) -> None:
+        self.rules = parse_script(text)
+        self.esp: Optional["EspAt"] = None
+        self.nick = "*"
+        self.buf = bytearray()
+        self.received: List[Tuple[int, str]] = []
+        self.unmatched: List[str] = []
+        self.listeners: List[Callable[[int, str], None]] = []
+
+    def connect(self) -> None:
+        self.buf.clear()
+        for rule in self.rules:
+            if rule.pattern == "@connect":
+                self._play(rule.replies, [])
+
+    def receive(self, data: bytes) -> None:
+        self.buf += data
+        while b"\n" in self.buf:
+            raw, _, rest = bytes(self.buf).partition(b"\n")
+            self.buf = bytearray(rest)
+            line = raw.rstrip(b"\r").decode("latin-1")
+            if line:
+                self._line(line)
+
+    def _line(self, line: str) -> None:
+        self.received.append((self.esp.cpu.t, line))
+        if line.upper().startswith("NICK "):
+            self.nick = line.split()[1].lstrip(":")
+        for rule in self.rules:
+            if rule.regex is None:
+                continue
+            m = rule.regex.search(line)
+            if not m:
+                continue
+            groups = [m.group(0)] + [g or "" for g in m.groups()]
+            if rule.each and len(groups) > 1:
+                for item in groups[1].split(","):
+                    self._play(rule.replies, [groups[0], item] + groups[2:])
+            else:
+                self._play(rule.replies, groups)
+            return
+        self.unmatched.append(line)
+
+    def _expand(self, text: str, groups: List[str]) -> str:
+        def sub(m: re.Match) -> str:
+            key = m.group(1)
+            if key == "nick":
+                return self.nick
+            if key.isdigit() and int(key) < len(groups):
+                return groups[int(key)]
+            return m.group(0)
+        return re.sub(r"\{(\w+)\}", sub, text)
+
+    def _play(self, replies: List[Tuple[float, str]], groups: List[str]) -> None:
+        offset = 0.0
+        for delay, text in replies:
+            offset += delay
+            if text == "@close":
+                self.esp.server_close(offset)
+                continue
+            line = self._expand(text, groups)
+            self.esp.downlink((line + "\r\n").encode("latin-1"), offset)
+            at_t = self.esp.cpu.t + self.esp.ms_t(offset)
+            for fn in self.listeners:
+                fn(at_t, line)
+
+
+# =============================================================================
+# ESP-AT model
+# =============================================================================
+
+class EspAt:
+    """ESP8266 AT firmware as seen from the Spectrum side of the UART."""
+
+    def __init__(self, machine: Spectrum48, server: IrcScript,
+                 latency_ms: Optional[Dict[str, float]] = None,
+                 echo: bool = True, wifi: bool = True) -> None:
+        self.m = machine
+        self.cpu = machine.cpu
+        self.uart = machine.uart
+        self.server = server
+        server.esp = self
+        self.lat = dict(DEFAULT_LATENCY_MS)
+        self.lat.update(latency_ms or {})
+        self.echo = echo
+        self.wifi = wifi
+        self.enabled = True
+        self.cipmode = 0
+        self.link: Optional[str] = None      # "TCP", "SSL", "UDP"
+        self.transparent = False
+        self.line = bytearray()
+        self.uplink = bytearray()
+        self.send_left = 0                    # CIPSEND=n bytes still expected
+        self.sendex = False                   # CIPSENDEX: "\\0" ends the frame
+        self.escape = False
+        self.recvmode = 0                     # CIPRECVMODE=1 holds downlink data
+        self.held = bytearray()
+        self.last_rx_t = -(1 << 40)
+        self.plus = 0
+        self.pack_armed = False
+        self.busy_t = 0                       # replies leave in command order
+        self.log: List[Tuple[int, str]] = []
+
+    def ms_t(self, ms: float) -> int:
+        return int(ms * CPU_HZ / 1000)
+
+    # -- UART side ----------------------------------------------------------
+    def tx(self, byte: int) -> None:
+        if not self.enabled:
+            return
+        now = self.cpu.t
+        gap = now - self.last_rx_t
+        self.last_rx_t = now
+        if self.transparent:
+            self._tx_data(byte, now, gap)
+            return
+        if self.send_left:
+            if self.sendex and self._sendex_byte(byte):
+                return
+            self.uplink.append(byte)
+            self.send_left -= 1
+            if not self.send_left:
+                self._send_done()
+            return
+        if self.echo:
+            self.uart.queue(now, bytes([byte]))
+        if byte in (0x0D, 0x0A):
+            if self.line:
+                self._command(self.line.decode("latin-1"))
+                self.line.clear()
+            return
+        self.line.append(byte)
+
+    def _tx_data(self, byte: int, now: int, gap: int) -> None:
+        guard = self.ms_t(self.lat["GUARD"])
+        if byte == 0x2B and self.plus < 3 and (self.plus or gap >= guard):
+            self.plus += 1
+            if self.plus == 3:
+                self.m.add_timer(now + guard, lambda mark=now: self._escape_check(mark))
+            return
+        if self.plus:
+            self.uplink += b"+" * self.plus
+            self.plus = 0
+        self.uplink.append(byte)
+        if len(self.uplink) >= PACKET_MAX:
+            self._flush()
+        elif not self.pack_armed:
+            self.pack_armed = True
+            self.m.add_timer(now + self.ms_t(self.lat["PACK"]), self._pack_check)
+
+    def _sendex_byte(self, byte: int) -> bool:
+        """CIPSENDEX escapes: "\\0" ends the frame, "\\\\" is one backslash."""
+        if self.escape:
+            self.escape = False
+            if byte == 0x30:
+                self.send_left = 0
+                self._send_done()
+                return True
+            return False
+        if byte == 0x5C:
+            self.escape = True
+            return True
+        return False
+
+    def _escape_check(self, mark: int) -> None:
+        if self.plus == 3 and self.last_rx_t == mark:
+            self.plus = 0
+            self.transparent = False
+            self.log.append((self.cpu.t, "+++"))
+
+    def _pack_check(self) -> None:
+        quiet_at = self.last_rx_t + self.ms_t(self.lat["PACK"])
+        if self.cpu.t < quiet_at:
+            self.m.add_timer(quiet_at, self._pack_check)
+            return
+        self.pack_armed = False
+        self._flush()
+
+    def _flush(self) -> None:
+        if not self.uplink:
+            return
+        data = bytes(self.uplink)
+        self.uplink.clear()
+        if self.link in ("TCP", "SSL"):
+            at_t = self.cpu.t + self.ms_t(self.lat["NET"])
+            self.m.add_timer(at_t, lambda d=data: self.server.receive(d))
+
+    # -- network side -------------------------------------------------------
+    def downlink(self, payload: bytes, delay_ms: float) -> None:
+        """Server bytes sent delay_ms from now; mode is decided on arrival."""
+        at_t = self.cpu.t + self.ms_t(delay_ms + self.lat["NET"])
+        self.m.add_timer(at_t, lambda p=payload: self._arrive(p))
+
+    def _arrive(self, payload: bytes) -> None:
+        if self.link not in ("TCP", "SSL"):
+            return
+        if self.recvmode and not self.transparent:
+            self.held += payload  # waits for AT+CIPRECVDATA
+            self.uart.queue(self.cpu.t, b"+IPD,%d\r\n" % len(self.held))
+            return
+        if not self.transparent:
+            payload = b"+IPD,%d:" % len(payload) + payload
+        self.uart.queue(self.cpu.t, payload)
+
+    def server_close(self, delay_ms: float = 0.0) -> None:
+        at_t = self.cpu.t + self.ms_t(delay_ms + self.lat["NET"])
+        self.m.add_timer(at_t, self._closed)
+
+    def _closed(self) -> None:
+        if self.link not in ("TCP", "SSL"):
+            return
+        self.link = None
+        self.transparent = False
+        self.uart.queue(self.cpu.t, b"CLOSED\r\n")
+
+    # -- AT commands --------------------------------------------------------
+    def _reply(self, key: str, payload: bytes,
+               then: Optional[Callable[[], None]] = None, extra_ms: float = 0.0) -> None:
+        ms = self.lat.get(key, self.lat["AT"]) + extra_ms
+        at_t = max(self.cpu.t + self.ms_t(ms), self.busy_t)
+        self.busy_t = at_t
+
+        def fire() -> None:
+            if then is not None:
+                then()
+            self.uart.queue(self.cpu.t, payload)
+        self.m.add_timer(at_t, fire)
+
+    def _command(self, text: str) -> None:
+        text = text.lstrip("+")  # "+++" has no terminator and prefixes the next command
+        self.log.append((self.cpu.t, text))
+        up = text.upper()
+        if not up.startswith("AT"):
+            return
+        name = up[3:] if up.startswith("AT+") else up
+        key, has_arg, _ = name.partition("=")
+        arg = text.partition("=")[2] if has_arg else ""
+        handler = self._handlers().get(key)
+        if handler is None:
+            self._reply(key, b"ERROR\r\n")
+        else:
+            handler(key, arg)
+
+    def _handlers(self) -> Dict[str, Callable[[str, str], None]]:
+        ok = self._ok
+        return {
+            "AT": ok, "ATE0": self._echo, "ATE1": self._echo,
+            "CIPMUX": ok, "CIPSERVER": ok, "CIPDINFO": ok, "CIPSSLSIZE": ok,
+            "CIPSNTPCFG": ok, "CIPMODE": self._cipmode,
+            "CIFSR": self._cifsr, "CWJAP?": self._cwjap, "CIPSNTPTIME?": self._sntptime,
+            "CIPDOMAIN": self._cipdomain, "CIPSTART": self._cipstart,
+            "CIPSEND": self._cipsend, "CIPCLOSE": self._cipclose,
+            "CIPSENDEX": self._cipsend, "CIPRECVMODE": self._ciprecvmode,
+            "CIPRECVDATA": self._ciprecvdata,
+        }
+
+    def _ok(self, key: str, arg: str) -> None:
+        self._reply(key, b"OK\r\n")
+
+    def _echo(self, key: str, arg: str) -> None:
+        self.echo = key == "ATE1"
+        self._reply(key, b"OK\r\n")
+
+    def _cipmode(self, key: str, arg: str) -> None:
+        self.cipmode = 1 if arg.strip() == "1" else 0
+        self._reply(key, b"OK\r\n")
+
+    def _cifsr(self, key: str, arg: str) -> None:
+        ip = IP_ADDR if self.wifi else "0.0.0.0"
+        self._reply(key, (f'+CIFSR:STAIP,"{ip}"\r\n'
+                          '+CIFSR:STAMAC,"5c:cf:7f:00:00:01"\r\n\r\nOK\r\n').encode())
+
+    def _cwjap(self, key: str, arg: str) -> None:
+        if self.wifi:
+            self._reply(key, b'+CWJAP:"benchnet","00:11:22:33:44:55",6,-48\r\n\r\nOK\r\n')
+        else:
+            self._reply(key, b"No AP\r\n\r\nOK\r\n")
+
+    def _sntptime(self, key: str, arg: str) -> None:
+        self._reply(key, f"+CIPSNTPTIME:{SNTP_TIME}\r\nOK\r\n".encode())
+
+    def _cipdomain(self, key: str, arg: str) -> None:
+        self._reply(key, b'+CIPDOMAIN:"216.239.35.0"\r\n\r\nOK\r\n')
+
+    def _cipstart(self, key: str, arg: str) -> None:
+        kind = arg.split(",")[0].strip().strip('"').upper()
+        if self.link is not None:
+            self._reply(key, b"ALREADY CONNECTED\r\n\r\nERROR\r\n")
+            return
+        if not self.wifi or kind not in ("TCP", "SSL", "UDP"):
+            self._reply(key, b"ERROR\r\n")
+            return
+
+        def opened(kind: str = kind) -> None:
+            self.link = kind
+            self.held.clear()
+            if kind != "UDP":
+                self.server.connect()
+        self._reply(key, b"CONNECT\r\n\r\nOK\r\n", opened,
+                    self.lat["SSL"] if kind == "SSL" else 0.0)
+
+    def _cipsend(self, key: str, arg: str) -> None:
+        if self.link is None:
+            self._reply(key, b"ERROR\r\n")
+        elif not arg:
+            if self.cipmode != 1 or self.link == "UDP":
+                self._reply(key, b"ERROR\r\n")
+                return
+
+            def enter() -> None:
+                self.transparent = True
+                self.plus = 0
+            self._reply(key, b"\r\nOK\r\n\r\n>", enter)
+        else:
+            self.send_left = max(1, int(arg.split(",")[-1] or "1"))
+            self.sendex = key == "CIPSENDEX"
+            self.escape = False
+            self._reply(key, b"\r\nOK\r\n> ")
+
+    def _ciprecvmode(self, key: str, arg: str) -> None:
+        self.recvmode = 1 if arg.strip() == "1" else 0
+        self._reply(key, b"OK\r\n")
+
+    def _ciprecvdata(self, key: str, arg: str) -> None:
+        want = int(arg.strip() or "0")
+        if not self.recvmode or not self.held or want <= 0:
+            self._reply(key, b"ERROR\r\n")
+            return
+        data = bytes(self.held[:want])
+        del self.held[:want]
+        self._reply(key, b"+CIPRECVDATA:%d," % len(data) + data + b"\r\nOK\r\n")
+
+    def _send_done(self) -> None:
+        size = len(self.uplink)
+        if self.link == "UDP":
+            self.uplink.clear()  # no NTP peer behind the bench
+        else:
+            self._flush()
+        self._reply("CIPSEND", b"\r\nRecv %d bytes\r\n\r\nSEND OK\r\n" % size)
+
+    def _cipclose(self, key: str, arg: str) -> None:
+        if self.link is None:
+            self._reply(key, b"ERROR\r\n")
+            return
+
+        def close() -> None:
+            self.link = None
+            self.transparent = False
+        self._reply(key, b"CLOSED\r\n\r\nOK\r\n", close)
+
+
+# =============================================================================
+# Connect bench
+# =============================================================================
+
+def connect_cfg(args: argparse.Namespace) -> str:
+    return (
+        "nick=benchzx\r\n"
+        "server=irc.bench.invalid\r\n"
+        f"port={6697 if args.ssl else 6667}\r\n"
+        f"passive={1 if args.passive else 0}\r\n"
+        "autoconnect=0\r\n"
+        "autojoin=1\r\n"
+        f"channels={args.channels}\r\n"
+        "tz=0\r\n"
+    )
+
+
+def parse_latency(items: List[str]) -> Dict[str, float]:
+    out: Dict[str, float] = {}
+    for item in items:
+        key, sep, value = item.partition("=")
+        if not sep:
+            raise SystemExit(f"zxesp: --latency wants KEY=ms, got {item!r}")
+        key = key.upper().removeprefix("AT+")
+        if key not in DEFAULT_LATENCY_MS and not key.startswith(("CIP", "CW", "ATE")):
+            raise SystemExit(f"zxesp: unknown latency key {key!r}")
+        out[key] = float(value)
+    return out
+
+
+class ConnectBench:
+    REQUIRED = ("_connection_state", "_temp_input", "_parse_user_input",
+                "_process_irc_data", "_rb_head", "_rb_tail", "_rx_pos")
+
+    def __init__(self, args: argparse.Namespace) -> None:
+        self.args = args
+        self.sym = parse_map(args.map)
+        missing = [n for n in self.REQUIRED if n not in self.sym]
+        if missing:
+            raise SystemExit(f"zxesp: not in map: {', '.join(missing)}")
+        cfg = args.cfg.read_text() if args.cfg else connect_cfg(args)
+        self.m, self.sandbox = make_machine(args, self.sym, cfg)
+        script = args.irc_script.read_text() if args.irc_script else DEFAULT_SCRIPT
+        self.server = IrcScript(script)
+        self.esp = EspAt(self.m, self.server, parse_latency(args.latency),
+                         echo=not args.no_echo)
+        self.m.at = self.esp
+        self.m.uart.tx_sink = self.esp.tx
+        self.server.listeners.append(self._server_sent)
+        self.m.add_trap(self.sym["_process_irc_data"], self._type_command)
+        self.m.frame_hooks.append(self._frame)
+        self.channels = len([c for c in args.channels.split(",") if c])
+        self.phase = "boot"
+        self.pending_cmd: Optional[str] = None
+        self.idle_until = 0
+        self.wifi_frame: Optional[int] = None
+        self.cycles: List[Dict[str, Optional[int]]] = []
+        self.cur: Dict[str, Optional[int]] = {}
+        self.names_done = 0
+
+    # -- emulator hooks -----------------------------------------------------
+    def _type_command(self, cpu) -> bool:
+        """At the main loop's IRC step, run parse_user_input(temp_input) first.
+
+        This is where the Enter key path calls it, so the command sees the
+        same state it would if typed.
+        """
+        if self.pending_cmd is None:
+            return False
+        text = self.pending_cmd.encode("latin-1") + b"\0"
+        self.pending_cmd = None
+        addr = self.sym["_temp_input"]
+        cpu.mem[addr:addr + len(text)] = text
+        cpu.push(cpu.pc)
+        cpu.hl = addr
+        cpu.pc = self.sym["_parse_user_input"]
+        self.cur["cmd"] = self.m.frames
+        return True
+
+    def _server_sent(self, at_t: int, line: str) -> None:
+        parts = line.split(" ", 2)
+        if len(parts) > 1 and parts[1] == "366":
+            self.names_done += 1
+
+    def _byte(self, name: str) -> int:
+        addr = self.sym.get(name)
+        return self.m.cpu.mem[addr] if addr is not None else 0
+
+    def _word(self, name: str) -> int:
+        addr = self.sym.get(name)
+        return self.m.cpu.rw(addr) if addr is not None else 0
+
+    def _rx_idle(self) -> bool:
+        return (self.m.uart.idle()
+                and self._word("_rb_head") == self._word("_rb_tail")
+                and self._word("_rx_pos") == 0
+                and not self._byte("_names_pending")
+                and not self._byte("_deferred_wrap_active"))
+
+    def _frame(self) -> None:
+        state = self._byte("_connection_state")
+        frames = self.m.frames
+        if self.phase == "boot":
+            if state >= STATE_WIFI_OK:
+                self.wifi_frame = frames
+                self._next_cycle()
+        elif self.phase == "idle":
+            if frames >= self.idle_until:
+                self.pending_cmd = "/server"
+                self.names_done = 0
+                self.phase = "connect"
+        elif self.phase == "connect":
+            if state == STATE_IRC_READY:
+                self.cur["welcome"] = frames
+                self.phase = "join"
+        elif self.phase == "join":
+            if self.names_done >= self.channels and self._rx_idle():
+                self.cur["joined"] = frames
+                self.cycles.append(self.cur)
+                if len(self.cycles) >= self.args.cycles:
+                    self.m.stop = True
+                    return
+                self.cur = {"drop": frames}
+                self.esp.server_close()
+                self.phase = "drop"
+        elif self.phase == "drop":
+            if state == STATE_WIFI_OK:
+                self.cur["ready"] = frames
+                self._next_cycle()
+
+    def _next_cycle(self) -> None:
+        self.idle_until = self.m.frames + self.args.idle_frames
+        self.phase = "idle"
+
+    # -- run ----------------------------------------------------------------
+    def run(self) -> dict:
+        max_t = int(self.args.max_seconds * CPU_HZ)
+        try:
+            self.m.run(max_t)
+        finally:
+            shutil.rmtree(self.sandbox, ignore_errors=True)
+        if self.wifi_frame is None:
+            raise SystemExit("zxesp: never reached STATE_WIFI_OK "
+                             f"(PC={self.m.cpu.pc:04X}, frames={self.m.frames})")
+        return self.report()
+
+    def report(self) -> dict:
+        def span(a: Optional[int], b: Optional[int]) -> Optional[int]:
+            return b - a if a is not None and b is not None else None
+
+        cycles = []
+        for cyc in self.cycles + ([self.cur] if self.cur and self.cur not in self.cycles else []):
+            cycles.append({
+                "drop_to_wifi_ok": span(cyc.get("drop"), cyc.get("ready")),
+                "server_to_001": span(cyc.get("cmd"), cyc.get("welcome")),
+                "001_to_autojoin": span(cyc.get("welcome"), cyc.get("joined")),
+            })
+        return {
+            "tap": str(self.args.tap),
+            "ssl": self.args.ssl,
+            "passive": self.args.passive,
+            "latency_ms": self.esp.lat,
+            "channels": self.args.channels,
+            "boot_to_wifi_ok": self.wifi_frame,
+            "cycles": cycles,
+            "complete": len(self.cycles) >= self.args.cycles,
+            "at_commands": len(self.esp.log),
+            "irc_lines_sent": len(self.server.received),
+            "irc_unmatched": self.server.unmatched[:20],
+            "uart_bytes_delivered": self.m.uart.delivered,
+            "uart_overrun_drops": self.m.uart.dropped,
+            "frames": self.m.frames,
+        }
+
+
+def print_report(rep: dict) -> None:
+    def f(n: Optional[int]) -> str:
+        return "-" if n is None else f"{n} frames ({n * FRAME_T * 1000 // CPU_HZ} ms)"
+
+    print("SpecTalkZX connect bench (uncontended, ESP-AT stand-in)")
+    print(f"  link         : {'SSL' if rep['ssl'] else 'TCP'}"
+          f"{' passive' if rep['passive'] else ''}, channels {rep['channels']}")
+    print(f"  boot->WiFi   : {f(rep['boot_to_wifi_ok'])}")
+    for i, cyc in enumerate(rep["cycles"], 1):
+        if cyc["drop_to_wifi_ok"] is not None:
+            print(f"  [{i}] drop->WiFi: {f(cyc['drop_to_wifi_ok'])}")
+        print(f"  [{i}] /server->001 : {f(cyc['server_to_001'])}")
+        print(f"  [{i}] 001->joined  : {f(cyc['001_to_autojoin'])}")
+    print(f"  AT commands  : {rep['at_commands']}, IRC lines sent {rep['irc_lines_sent']}")
+    print(f"  UART         : {rep['uart_bytes_delivered']} B in, "
+          f"overrun drops {rep['uart_overrun_drops']}")
+    for line in rep["irc_unmatched"]:
+        print(f"  unmatched    : {line}")
+    if not rep["complete"]:
+        print("  INCOMPLETE   : hit --max-seconds before the last cycle finished")
+
+
+def build_arg_parser() -> argparse.ArgumentParser:
+    ap = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    ap.add_argument("--tap", type=Path, default=Path("build/SpecTalkZX.tap"))
+    ap.add_argument("--map", type=Path, default=Path("SpecTalkZX.map"))
+    ap.add_argument("--build-dir", type=Path, default=Path("build"))
+    ap.add_argument("--rom", type=Path, help="optional 16K 48K ROM image")
+    ap.add_argument("--cfg", type=Path,
+                    help="SPECTALK.CFG to boot with (default: bench nick, autojoin --channels)")
+    ap.add_argument("--fifo", type=int, default=1, help="UART RX FIFO depth in bytes (default 1)")
+    ap.add_argument("--ssl", action="store_true", help="connect to port 6697 (CIPSTART \"SSL\")")
+    ap.add_argument("--passive", action="store_true",
+                    help="boot with passive=1 (CIPRECVMODE=1; needs make passive)")
+    ap.add_argument("--channels", default="#bench,#zx", help="autojoin list (default #bench,#zx)")
+    ap.add_argument("--latency", action="append", default=[], metavar="KEY=MS",
+                    help="override an ESP latency (keys: "
+                         + ", ".join(DEFAULT_LATENCY_MS) + ")")
+    ap.add_argument("--no-echo", action="store_true", help="start with ATE0 in effect")
+    ap.add_argument("--irc-script", type=Path, help="server script (format: DEFAULT_SCRIPT)")
+    ap.add_argument("--cycles", type=int, default=1,
+                    help="connect cycles; the server drops the link between them")
+    ap.add_argument("--idle-frames", type=int, default=100,
+                    help="frames to idle at STATE_WIFI_OK before /server")
+    ap.add_argument("--max-seconds", type=float, default=300.0, help="emulated time limit")
+    ap.add_argument("--json", type=Path, help="also write the report as JSON")
+    return ap
+
+
+def main() -> int:
+    args = build_arg_parser().parse_args()
+    for path in (args.tap, args.map):
+        if not path.exists():
+            print(f"zxesp: missing {path}", file=sys.stderr)
+            return 2
+    rep = ConnectBench(args).run()
+    print_report(rep)
+    if args.json:
+        args.json.write_text(json.dumps(rep, indent=2) + "\n")
+    return 0 if rep["complete"] else 1
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,319 @@
+#!/usr/bin/env python3
+"""Per-kernel microbenchmarks for the hand-written rendering asm.
+
+Boots the built TAP on the zxbench machine until the main loop first enters
+_process_irc_data (fonts, theme, BPE dictionary and screen state are then
+live), snapshots RAM and registers, and calls each kernel in isolation from
+that snapshot with interrupts disabled. Every case starts from the same
+seeded screen pattern and records:
+
+    T-states   from the CALL to the kernel's RET (uncontended)
+    crc32      of bitmap + attributes (0x4000-0x5AFF) after the call
+
+Results are appended to a TSV keyed by git revision (`-dirty` when asm/,
+src/, include/ or overlay/ has local changes); a rerun on the same revision
+replaces its rows. The run then prints the delta against the newest other
+revision in the table, or --baseline REV, and flags pixel changes.
+
+Usage:
+    python tools/zxkbench.py
+    python tools/zxkbench.py --baseline 4c55f2d --strict
+"""
+
+from __future__ import annotations
+
+import argparse
+import random
+import shutil
+import subprocess
+import sys
+import zlib
+from pathlib import Path
+from typing import Callable, Dict, List, Optional, Tuple
+
+sys.path.insert(0, str(Path(__file__).resolve().parent))
+from zxbench import make_machine, parse_map  # noqa: E402
+
+SCREEN = 0x4000
+SCREEN_END = 0x5B00
+ATTR = 0x5800
+RET_SENTINEL = 0x3FF0  # ROM address no kernel returns to on its own
+MAIN_START = 3
+MAIN_LINES = 17
+LINE_BUFFER_SIZE = 128
+CASE_LIMIT_T = 5_000_000
+
+# Fixed printer-buffer scratch, not always exported to the map.
+PLF_START_BYTE = 0x5BD2
+PLF_PAIR_COUNT = 0x5BEF
+
+TEXT64 = "The quick brown fox jumps over the lazy dog 0123456789 !?#@&*()."
+NAMES = " ".join(["@op", "+voice", "benchzx", "averyveryverylongnick", "zx81"]
+                 + [f"user{i:03d}" for i in range(40)])
+TRACKED_DIRS = ["asm", "src", "include", "overlay"]
+
+
+class _Return(Exception):
+    pass
+
+
+def git_rev() -> str:
+    try:
+        rev = subprocess.run(["git", "rev-parse", "--short", "HEAD"], capture_output=True,
+                             text=True, check=True).stdout.strip()
+        dirty = subprocess.run(["git", "status", "--porcelain", "--"] + TRACKED_DIRS,
+                               capture_output=True, text=True, check=True).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return "norev"
+    return rev + ("-dirty" if dirty else "")
+
+
+# =============================================================================
+# Kernel runner
+# =============================================================================
+
+class KernelBench:
+    def __init__(self, args: argparse.Namespace) -> None:
+        self.sym = parse_map(args.map)
+        self.m, sandbox = make_machine(args, self.sym)
+        self.cpu = self.m.cpu
+        try:
+            self._boot(int(args.max_seconds * 3_500_000))
+        finally:
+            shutil.rmtree(sandbox, ignore_errors=True)
+        self.mem0 = bytes(self.cpu.mem)
+        self.regs0 = {k: v for k, v in vars(self.cpu).items()
+                      if isinstance(v, int) and not isinstance(v, bool)}
+        rng = random.Random(0x5EC7)
+        self.pattern = bytes(rng.getrandbits(8) for _ in range(ATTR - SCREEN)) \
+            + bytes([0x38]) * (SCREEN_END - ATTR)
+        self.scratch = self.addr("_ring_buffer")
+        self.cpu.traps[RET_SENTINEL] = self._sentinel
+
+    def _boot(self, max_t: int) -> None:
+        entry = self.addr("_process_irc_data")
+
+        def stop(cpu) -> bool:
+            raise _Return()
+
+        self.cpu.traps[entry] = stop
+        try:
+            self.m.run(max_t)
+        except _Return:
+            del self.cpu.traps[entry]
+            return
+        raise SystemExit(f"zxkbench: boot never reached process_irc_data (PC={self.cpu.pc:04X})")
+
+    def _sentinel(self, cpu) -> bool:
+        raise _Return()
+
+    def addr(self, name: str) -> int:
+        if name not in self.sym:
+            raise KeyError(name)
+        return self.sym[name]
+
+    def poke(self, name: str, value: int) -> None:
+        self.cpu.mem[self.addr(name)] = value & 0xFF
+
+    def text(self, data: bytes) -> int:
+        """Place a NUL-terminated string in the ring; call from setup only."""
+        self.cpu.mem[self.scratch:self.scratch + len(data) + 1] = data + b"\0"
+        return self.scratch
+
+    def call(self, kernel: str, setup: Callable[[], Optional[int]],
+             stack_args: bytes = b"") -> Tuple[int, int]:
+        cpu = self.cpu
+        cpu.mem[:] = self.mem0
+        for key, value in self.regs0.items():
+            setattr(cpu, key, value)
+        cpu.mem[SCREEN:SCREEN_END] = self.pattern
+        hl = setup()
+        if hl is not None:
+            cpu.h, cpu.l = hl >> 8, hl & 0xFF
+        sp = (self.regs0["sp"] - 32 - len(stack_args)) & 0xFFFF
+        cpu.mem[sp:sp + len(stack_args)] = stack_args
+        sp -= 2
+        cpu.mem[sp] = RET_SENTINEL & 0xFF
+        cpu.mem[sp + 1] = RET_SENTINEL >> 8
+        cpu.sp = sp
+        cpu.iff1 = cpu.iff2 = False
+        cpu.halted = False
+        cpu.pc = self.addr(kernel)
+        t0 = cpu.t
+        try:
+            self.m.run(t0 + CASE_LIMIT_T)
+        except _Return:
+            return cpu.t - t0 + 17, zlib.crc32(bytes(cpu.mem[SCREEN:SCREEN_END]))
+        raise SystemExit(f"zxkbench: {kernel} did not return within {CASE_LIMIT_T} T")
+
+
+def ptr_arg(value: int) -> bytes:
+    return bytes([value & 0xFF, value >> 8])
+
+
+def cases(kb: KernelBench) -> List[Tuple[str, str, Callable[[], Tuple[int, int]]]]:
+    """(kernel, case, runner) for every benchmarked call."""
+    out: List[Tuple[str, str, Callable[[], Tuple[int, int]]]] = []
+
+    def at_line(line: int, col: int) -> None:
+        kb.poke("_main_line", line)
+        kb.poke("_main_col", col)
+
+    for start in range(32):
+        def plf(start: int = start) -> Tuple[int, int]:
+            def setup() -> None:
+                kb.cpu.mem[kb.sym.get("_plf_start_byte", PLF_START_BYTE)] = start
+                kb.cpu.mem[PLF_PAIR_COUNT] = 0
+                kb.text(TEXT64.encode())
+            return kb.call("_print_line64_fast", setup,
+                           bytes([12]) + ptr_arg(kb.scratch) + bytes([0x47]))
+        out.append(("print_line64_fast", f"start{start:02d}", plf))
+
+    bpe = bytes(b for i, ch in enumerate(b"status of the channel list here")
+                for b in ((0x80 + i % 32, ch) if i % 3 == 0 else (ch,)))
+    for name, payload, col in (("ascii_even", TEXT64[:60].encode(), 0),
+                               ("ascii_odd", TEXT64[:60].encode(), 1),
+                               ("bpe_tokens", bpe, 0)):
+        def puts(payload: bytes = payload, col: int = col) -> Tuple[int, int]:
+            def setup() -> int:
+                at_line(10, col)
+                return kb.text(payload)
+            return kb.call("_main_puts", setup)
+        out.append(("main_puts", name, puts))
+
+    out.append(("scroll_main_zone", "main",
+                lambda: kb.call("_scroll_main_zone", lambda: None)))
+    out.append(("clear_zone", "main",
+                lambda: kb.call("_clear_zone", lambda: None,
+                                bytes([MAIN_START, MAIN_LINES, 0x38, 0]))))
+    out.append(("clear_zone", "input",
+                lambda: kb.call("_clear_zone", lambda: None, bytes([22, 2, 0x38, 0]))))
+    out.append(("cls_fast", "full", lambda: kb.call("_cls_fast", lambda: None)))
+
+    def names() -> Tuple[int, int]:
+        def setup() -> int:
+            at_line(MAIN_START, 0)
+            return kb.text(NAMES.encode())
+        return kb.call("_names_render_grid", setup)
+    out.append(("names_render_grid", "45_nicks", names))
+
+    for name, length in (("empty", 0), ("half", 40), ("full", LINE_BUFFER_SIZE - 1)):
+        def redraw(length: int = length) -> Tuple[int, int]:
+            def setup() -> None:
+                buf = kb.addr("_line_buffer")
+                data = (TEXT64 * 2)[:length].encode()
+                kb.cpu.mem[buf:buf + length + 1] = data + b"\0"
+                kb.poke("_line_len", length)
+            return kb.call("_redraw_input_asm", setup)
+        out.append(("redraw_input_asm", name, redraw))
+
+    for name, col in (("col0", 0), ("col20", 20)):
+        def notif(col: int = col) -> Tuple[int, int]:
+            def setup() -> None:
+                kb.text(b"alice mentioned you in #spectrum")
+            return kb.call("_notif_draw", setup,
+                           bytes([col]) + ptr_arg(kb.scratch) + bytes([0x45]))
+        out.append(("notif_draw", name, notif))
+    return out
+
+
+# =============================================================================
+# Results table
+# =============================================================================
+
+Row = Tuple[str, str, str, int, int]  # rev, kernel, case, T, crc32
+HEADER = "rev\tkernel\tcase\tt_states\tcrc32\n"
+
+
+def load_table(path: Path) -> List[Row]:
+    rows: List[Row] = []
+    if not path.exists():
+        return rows
+    for line in path.read_text().splitlines()[1:]:
+        parts = line.split("\t")
+        if len(parts) == 5:
+            rows.append((parts[0], parts[1], parts[2], int(parts[3]), int(parts[4], 16)))
+    return rows
+
+
+def save_table(path: Path, rows: List[Row]) -> None:
+    path.parent.mkdir(parents=True, exist_ok=True)
+    with path.open("w") as out:
+        out.write(HEADER)
+        for rev, kernel, case, t, crc in rows:
+            out.write(f"{rev}\t{kernel}\t{case}\t{t}\t{crc:08x}\n")
+
+
+def print_results(rev: str, new: List[Row], base_rev: Optional[str],
+                  base: Dict[Tuple[str, str], Tuple[int, int]]) -> int:
+    against = f" vs {base_rev}" if base_rev else ""
+    print(f"SpecTalkZX kernel bench @ {rev}{against} (uncontended T-states)")
+    print(f"  {'kernel':<20}{'case':<12}{'T':>9}{'delta':>9}{'%':>8}  crc32")
+    changed = 0
+    for _, kernel, case, t, crc in new:
+        old = base.get((kernel, case))
+        if old is None:
+            print(f"  {kernel:<20}{case:<12}{t:>9}{'':>9}{'':>8}  {crc:08x}")
+            continue
+        delta = t - old[0]
+        pct = 100.0 * delta / old[0] if old[0] else 0.0
+        flag = "" if crc == old[1] else f"  PIXELS (was {old[1]:08x})"
+        changed += bool(flag)
+        print(f"  {kernel:<20}{case:<12}{t:>9}{delta:>+9}{pct:>+7.1f}%  {crc:08x}{flag}")
+    if base_rev:
+        print(f"  pixel changes: {changed}")
+    return changed
+
+
+def build_arg_parser() -> argparse.ArgumentParser:
+    ap = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    ap.add_argument("--tap", type=Path, default=Path("build/SpecTalkZX.tap"))
+    ap.add_argument("--map", type=Path, default=Path("SpecTalkZX.map"))
+    ap.add_argument("--build-dir", type=Path, default=Path("build"))
+    ap.add_argument("--rom", type=Path, help="optional 16K 48K ROM image")
+    ap.add_argument("--cfg", type=Path, help="SPECTALK.CFG to boot with (default: bench nick)")
+    ap.add_argument("--table", type=Path, default=Path("build/kernel_bench.tsv"))
+    ap.add_argument("--baseline", help="revision to compare against (default: newest other)")
+    ap.add_argument("--only", nargs="+", help="run only these kernels")
+    ap.add_argument("--strict", action="store_true", help="exit 1 on any pixel change")
+    ap.add_argument("--max-seconds", type=float, default=60.0, help="emulated boot limit")
+    ap.set_defaults(fifo=1)
+    return ap
+
+
+def main() -> int:
+    args = build_arg_parser().parse_args()
+    for path in (args.tap, args.map):
+        if not path.exists():
+            print(f"zxkbench: missing {path}", file=sys.stderr)
+            return 2
+    rev = git_rev()
+    kb = KernelBench(args)
+    new: List[Row] = []
+    missing: Dict[str, str] = {}
+    for kernel, case, run in cases(kb):
+        if args.only and kernel not in args.only or kernel in missing:
+            continue
+        try:
+            t, crc = run()
+        except KeyError as exc:
+            missing[kernel] = exc.args[0]
+            continue
+        new.append((rev, kernel, case, t, crc))
+
+    rows = [r for r in load_table(args.table) if r[0] != rev]
+    base_rev = args.baseline
+    if base_rev is None:
+        for row in reversed(rows):
+            base_rev = row[0]
+            break
+    base = {(k, c): (t, crc) for r, k, c, t, crc in rows if r == base_rev}
+    changed = print_results(rev, new, base_rev if base else None, base)
+    for kernel, name in missing.items():
+        print(f"  {kernel:<20}({name} not in map)")
+    save_table(args.table, rows + new)
+    return 1 if args.strict and changed else 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,233 @@
+#!/usr/bin/env python3
+"""PC-sampling profiler for zxbench runs.
+
+Every N T-states the current PC is resolved against SpecTalkZX.map (the same
+`name = $XXXX ;` lines tools/gen_overlay_defs.py reads) and the stack is
+walked for return addresses, giving a flat self profile, an inclusive
+profile and collapsed call stacks (flamegraph.pl / speedscope input).
+
+Overlay code runs from _ring_buffer, which the map only knows as one data
+symbol. Samples there are attributed through the STOA atlas instead: the
+profiler traps _overlay_exec to learn which SPCTLKn.OVL was loaded, and
+names the code after the nearest entry point at or below the PC, using the
+entry names from overlay/overlay_entry*.asm.
+
+Used through zxbench:
+    python tools/zxbench.py --capture build/corpus/names.srx --profile 1000
+    make bench BENCH_CAPTURE=build/corpus/names.srx BENCH_PROFILE=1000
+"""
+
+from __future__ import annotations
+
+import bisect
+import re
+import struct
+from collections import Counter
+from pathlib import Path
+from typing import Dict, List, Optional, Tuple
+
+ATLAS_MAGIC = b"STOA"
+RING_SIZE = 2048
+STACK_TOP = 0xFF58
+STACK_WALK_MAX = 96  # words; the resident stack is 512 bytes
+
+MAP_FULL_RE = re.compile(
+    r"^(\w+)\s+=\s+\$([0-9A-Fa-f]+)\s+;\s*(\w+)\s*,\s*(\w+)\s*,[^,]*,[^,]*,\s*([\w.]*)")
+ENTRY_RE = re.compile(r"^\s*dw\s+(\w+)", re.IGNORECASE)
+
+# Opcodes that push a return address: CALL nn, CALL cc,nn (3 bytes), RST (1).
+_CALL_OPS = {0xCD, 0xC4, 0xCC, 0xD4, 0xDC, 0xE4, 0xEC, 0xF4, 0xFC}
+_RST_OPS = {0xC7, 0xCF, 0xD7, 0xDF, 0xE7, 0xEF, 0xF7, 0xFF}
+
+
+# =============================================================================
+# Symbol sources
+# =============================================================================
+
+class CodeSymbols:
+    """Sorted code symbols from a z88dk map; locals only when asked for."""
+
+    def __init__(self, map_path: Path, locals_too: bool = False) -> None:
+        seen: Dict[int, str] = {}
+        for line in map_path.read_text(errors="replace").splitlines():
+            m = MAP_FULL_RE.match(line.strip())
+            if not m:
+                continue
+            name, addr, kind, scope, section = m.groups()
+            if kind != "addr" or not section.startswith("code"):
+                continue
+            if scope == "local" and not locals_too:
+                continue
+            addr_i = int(addr, 16)
+            # Prefer C-visible names (_foo) over asm aliases at one address.
+            if addr_i not in seen or (name.startswith("_") and not seen[addr_i].startswith("_")):
+                seen[addr_i] = name
+        self.addrs = sorted(seen)
+        self.names = [seen[a] for a in self.addrs]
+
+    def resolve(self, pc: int) -> Optional[str]:
+        i = bisect.bisect_right(self.addrs, pc) - 1
+        return self.names[i] if i >= 0 else None
+
+    def is_code(self, addr: int) -> bool:
+        return bool(self.addrs) and self.addrs[0] <= addr
+
+
+def overlay_entry_names(overlay_dir: Path) -> Dict[int, List[str]]:
+    """SPCTLKn entry table names from overlay_entry*.asm (n = 1..8)."""
+    names: Dict[int, List[str]] = {}
+    for path in sorted(overlay_dir.glob("overlay_entry*.asm")):
+        suffix = path.stem[len("overlay_entry"):]
+        ovl = int(suffix) if suffix.isdigit() else 1
+        dws = []
+        for line in path.read_text(errors="replace").splitlines():
+            m = ENTRY_RE.match(line)
+            if m:
+                dws.append(m.group(1))
+            elif dws:
+                break
+        if dws and dws[0].isdigit():
+            names[ovl] = dws[1:1 + int(dws[0])]
+    return names
+
+
+class OverlayAtlas:
+    """Entry addresses per overlay, read from the packed STOA atlas."""
+
+    def __init__(self, atlas: Optional[Path], slot: int,
+                 entry_names: Dict[int, List[str]]) -> None:
+        self.slot = slot
+        self.entries: Dict[int, List[Tuple[int, str]]] = {}
+        if atlas is None or not atlas.exists():
+            return
+        data = atlas.read_bytes()
+        if data[:4] != ATLAS_MAGIC:
+            return
+        count = data[5]
+        for idx in range(count):
+            offset, size = struct.unpack_from("<HH", data, 8 + idx * 4)
+            body = data[offset:offset + size]
+            if len(body) < 2:
+                continue
+            n_entries = body[0]
+            ovl = idx + 1
+            labels = entry_names.get(ovl, [])
+            table = []
+            for e in range(n_entries):
+                if 2 + e * 2 + 1 >= len(body):
+                    break
+                addr = body[2 + e * 2] | (body[3 + e * 2] << 8)
+                label = labels[e] if e < len(labels) else f"entry{e}"
+                table.append((addr, label.lstrip("_")))
+            table.sort()
+            self.entries[ovl] = table
+
+    def resolve(self, ovl: int, pc: int) -> str:
+        prefix = f"SPCTLK{ovl}.OVL" if ovl else "ring_buffer"
+        best = None
+        for addr, label in self.entries.get(ovl, []):
+            if addr <= pc:
+                best = label
+        if best is None:
+            return f"{prefix}:+{pc - self.slot:03X}"
+        return f"{prefix}:{best}"
+
+
+# =============================================================================
+# Sampler
+# =============================================================================
+
+class Profiler:
+    def __init__(self, machine, map_path: Path, every_t: int,
+                 atlas: Optional[Path], overlay_dir: Path,
+                 locals_too: bool = False) -> None:
+        self.m = machine
+        self.cpu = machine.cpu
+        self.every_t = max(64, every_t)
+        self.code = CodeSymbols(map_path, locals_too)
+        self.slot = machine.sym_addr("_ring_buffer") or 0
+        self.atlas = OverlayAtlas(atlas, self.slot, overlay_entry_names(overlay_dir))
+        self.loaded_ovl = 0
+        self.active = False
+        self.samples = 0
+        self.flat: Counter = Counter()
+        self.inclusive: Counter = Counter()
+        self.stacks: Counter = Counter()
+        exec_addr = machine.sym_addr("_overlay_exec")
+        if exec_addr is not None:
+            machine.add_trap(exec_addr, self._overlay_exec)
+
+    def _overlay_exec(self, cpu) -> bool:
+        # __z88dk_callee: [SP]=ret, [SP+2]=ovl_id, [SP+3]=entry_id.
+        self.loaded_ovl = cpu.mem[(cpu.sp + 2) & 0xFFFF] + 1
+        return False
+
+    def start(self) -> None:
+        self.active = True
+        self.m.add_timer(self.cpu.t + self.every_t, self._sample)
+
+    def _name(self, pc: int) -> str:
+        if pc < 0x4000:
+            return "[ROM]"
+        if self.slot and self.slot <= pc < self.slot + RING_SIZE:
+            return self.atlas.resolve(self.loaded_ovl, pc)
+        return self.code.resolve(pc) or f"${pc:04X}"
+
+    def _is_return_address(self, addr: int) -> bool:
+        if addr < 0x4000 or not self.code.is_code(addr) and not self._in_ring(addr):
+            return False
+        mem = self.cpu.mem
+        return mem[(addr - 3) & 0xFFFF] in _CALL_OPS or mem[(addr - 1) & 0xFFFF] in _RST_OPS
+
+    def _in_ring(self, addr: int) -> bool:
+        return bool(self.slot) and self.slot <= addr < self.slot + RING_SIZE
+
+    def _sample(self) -> None:
+        if not self.active:
+            return
+        cpu = self.cpu
+        leaf = self._name(cpu.pc)
+        chain = [leaf]
+        sp = cpu.sp
+        for _ in range(STACK_WALK_MAX):
+            if sp >= STACK_TOP:
+                break
+            word = cpu.rw(sp)
+            sp += 2
+            if self._is_return_address(word):
+                name = self._name(word)
+                if name != chain[-1]:
+                    chain.append(name)
+        self.samples += 1
+        self.flat[leaf] += 1
+        for name in set(chain):
+            self.inclusive[name] += 1
+        self.stacks[";".join(reversed(chain))] += 1
+        self.m.add_timer(cpu.t + self.every_t, self._sample)
+
+    def report(self, top: int = 25) -> dict:
+        total = max(1, self.samples)
+
+        def rows(counter: Counter) -> List[dict]:
+            return [{"symbol": name, "samples": n, "pct": round(100.0 * n / total, 2)}
+                    for name, n in counter.most_common(top)]
+
+        return {
+            "every_t": self.every_t,
+            "samples": self.samples,
+            "flat": rows(self.flat),
+            "inclusive": rows(self.inclusive),
+        }
+
+    def write_collapsed(self, path: Path) -> None:
+        with path.open("w") as out:
+            for stack, n in sorted(self.stacks.items()):
+                out.write(f"{stack} {n}\n")
+
+
+def print_profile(prof: dict) -> None:
+    print(f"  profile      : {prof['samples']} samples, 1 per {prof['every_t']} T")
+    for title, key in (("self", "flat"), ("inclusive", "inclusive")):
+        print(f"  {title + ' %':<10}{'samples':>9}  symbol")
+        for row in prof[key]:
+            print(f"  {row['pct']:>8.2f}{row['samples']:>11}  {row['symbol']}")
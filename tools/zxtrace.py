@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""Decode the event trace ring of a make trace build.
+
+!trace writes TRACE.BIN on the SD card: "STT1", then TraceRing as it sits in
+RAM (include/spectalk.h): one head byte counting records mod 256 and
+TRACE_RECORDS 4-byte records {id, FRAMES low byte, arg lo, arg hi}. The
+next slot to be written is head % TRACE_RECORDS, so the oldest record sits
+there once the ring has wrapped; slots never written still have id 0.
+
+FRAMES is only 8 bits, so the timeline assumes consecutive records are less
+than 256 frames (5.12 s) apart. zxbench reads _trace_ring straight from
+emulated RAM with the same decoder.
+
+Usage:
+    python tools/zxtrace.py TRACE.BIN
+    python tools/zxtrace.py TRACE.BIN --json trace.json
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import sys
+from pathlib import Path
+from typing import Dict, List
+
+TRACE_MAGIC = b"STT1"
+TRACE_RECORDS = 64
+RING_BYTES = 1 + TRACE_RECORDS * 4
+FRAME_MS = 20
+
+# TR_* ids from include/spectalk.h.
+EVENT_NAMES = {
+    1: "irc_in",
+    2: "irc_out",
+    3: "dispatch",
+    4: "overlay",
+    5: "scroll",
+    6: "disconnect",
+    7: "ping",
+    8: "pong",
+    9: "dump",
+}
+STATE_NAMES = ("DISCONNECTED", "WIFI_OK", "TCP_CONNECTED", "IRC_READY")
+
+
+def cmd_id_name(cmd_id: int) -> str:
+    """last_cmd_id: a numeric below 1000 or the first two uppercase letters."""
+    if cmd_id < 1000:
+        return f"{cmd_id:03d}"
+    return chr(cmd_id >> 8) + chr(cmd_id & 0xFF)
+
+
+def describe(event: int, arg: int) -> str:
+    if event in (1, 2):
+        return f"backlog {arg} B"
+    if event == 3:
+        return cmd_id_name(arg)
+    if event == 4:
+        return f"SPCTLK{(arg & 0xFF) + 1}.OVL entry {arg >> 8}"
+    if event == 5:
+        return f"backlog {arg} B"
+    if event == 6:
+        return STATE_NAMES[arg] if arg < len(STATE_NAMES) else f"state {arg}"
+    if event == 7:
+        return f"silent {arg} frames"
+    if event == 8:
+        return f"{arg * FRAME_MS} ms after PING"
+    if event == 9:
+        return f"{arg} records written (mod 256)"
+    return f"arg {arg:#06x}"
+
+
+def decode(ring: bytes) -> List[Dict[str, object]]:
+    """Records oldest first, with FRAMES unwrapped relative to the oldest."""
+    if len(ring) < RING_BYTES:
+        raise ValueError(f"trace ring is {len(ring)} bytes, expected {RING_BYTES}")
+    head = ring[0]
+    events = []
+    frame = 0
+    prev = None
+    for i in range(TRACE_RECORDS):
+        slot = (head + i) % TRACE_RECORDS
+        ev, lo, a_lo, a_hi = ring[1 + slot * 4:5 + slot * 4]
+        if ev == 0:
+            continue
+        if prev is not None:
+            frame += (lo - prev) & 0xFF
+        prev = lo
+        arg = a_lo | (a_hi << 8)
+        events.append({
+            "frame": frame,
+            "event": EVENT_NAMES.get(ev, str(ev)),
+            "arg": arg,
+            "text": describe(ev, arg),
+        })
+    return events
+
+
+def read_file(path: Path) -> List[Dict[str, object]]:
+    data = path.read_bytes()
+    if data[:4] != TRACE_MAGIC:
+        raise ValueError(f"{path}: not an STT1 trace")
+    return decode(data[4:])
+
+
+def format_events(events: List[Dict[str, object]]) -> List[str]:
+    lines = []
+    last = 0
+    for e in events:
+        frame = int(e["frame"])
+        lines.append(f"{frame:>6} {'+' + str(frame - last):>5}  {e['event']:<11}{e['text']}")
+        last = frame
+    return lines
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    ap.add_argument("trace", type=Path, help="TRACE.BIN written by !trace")
+    ap.add_argument("--json", type=Path, help="also write the events as JSON")
+    args = ap.parse_args()
+    try:
+        events = read_file(args.trace)
+    except (OSError, ValueError) as exc:
+        print(f"zxtrace: {exc}", file=sys.stderr)
+        return 2
+    print(f"{'frame':>6} {'delta':>5}  {'event':<11}detail")
+    for line in format_events(events):
+        print(line)
+    if args.json:
+        args.json.write_text(json.dumps(events, indent=2) + "\n")
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())